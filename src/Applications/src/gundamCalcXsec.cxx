@@ -504,6 +504,9 @@ int main(int argc, char** argv){
       std::for_each(dataEvList.begin(), dataEvList.end(), []( Event& ev_){ ev_.getWeights().current = 0; });
     }
   }
+  // the weights are modified outside the dial cache: the next propagation
+  // can't only reweight the events depending on the moved parameters
+  propagator.getEventDialCache().requestFullReweight();
 
   bool enableEventMcThrow{true};
   bool enableStatThrowInToys{true};
@@ -576,6 +579,7 @@ int main(int argc, char** argv){
         xsec.branchBinsData.writeRawData( binData );
       }
     }
+    propagator.getEventDialCache().requestFullReweight();
   });
 
   {
@@ -612,6 +616,7 @@ int main(int argc, char** argv){
         // Asimov bin content -> toy data
         xsec.samplePtr->getMcContainer().throwStatError();
       }
+      propagator.getEventDialCache().requestFullReweight();
     }
 
     writeBinDataFct();
@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <vector>
 
 namespace Cache {
     class IndexedSums;
@@ -16,13 +17,38 @@ namespace Cache {
 /// the actual calculation is controled for the GPU.  It's used by the cache
 /// manager when the GPU needs to be fired up.
 class Cache::IndexedSums {
+public:
+    /// How the histogram bin of each entry is stored.  Automatic uses 16 bit
+    /// indices when the bins fit, and 32 bit indices otherwise.  The default
+    /// is Int32 (the "cacheManagerIndexWidth" option of the propagator).
+    enum class IndexWidth {Automatic, Int32, UInt16};
+
+    /// The largest number of bins that fit in 16 bit indices.
+    static constexpr std::size_t kPackedBinLimit = 65536;
+
+    /// The number of bins above which the sums are done with a segmented
+    /// reduction (see fSortedEntries).
+    static constexpr std::size_t kSegmentedBinLimit = 1<<20;
+
 private:
     // Save the event weight cache reference for later use
     Cache::Weights::Results& fEventWeights;
 
     // The histogram bin index for each entry in the fWeights array (this is
-    // the same size as fEventWeights.
-    std::unique_ptr<hemi::Array<short>> fIndexes;
+    // the same size as fEventWeights.  Only one of the arrays is allocated,
+    // depending on the index width.
+    std::unique_ptr<hemi::Array<int>> fIndexes;
+    std::unique_ptr<hemi::Array<std::uint16_t>> fPackedIndexes;
+
+    // The entries sorted by histogram bin, and the position of the first
+    // entry of each bin in fSortedEntries (with one extra element for the
+    // end of the last bin).  With these, each bin is summed by one thread
+    // without atomic operations (a segmented reduction).  This is used for
+    // very large binnings, and is filled when the indices change.
+    bool fSegmented{false};
+    bool fSegmentsValid{false};
+    std::unique_ptr<hemi::Array<int>> fSortedEntries;
+    std::unique_ptr<hemi::Array<int>> fBinStarts;
 
     // The accumulated weights for each histogram bin.
     std::unique_ptr<hemi::Array<double>> fSums;
@@ -30,6 +56,11 @@ private:
     // The accumulated weights for each histogram bin.
     std::unique_ptr<hemi::Array<double>> fSums2;
 
+    // The partial sums of each host thread when the kernels run on several
+    // threads without a GPU (one block of bins per thread).
+    std::vector<double> fPartialSums;
+    std::vector<double> fPartialSums2;
+
     // Cache of whether the result values in memory are valid.
     bool fSumsValid;
 
@@ -38,7 +69,8 @@ private:
 
 public:
     IndexedSums(Cache::Weights::Results& eventWeight,
-               std::size_t bins);
+               std::size_t bins,
+               IndexWidth width = IndexWidth::Int32);
 
     /// Deconstruct the class.  This should deallocate all the memory
     /// everyplace.
@@ -54,6 +86,15 @@ public:
     // Assigns the bin number that an event will be added to.
     void SetEventIndex(int event, int bin);
 
+    // Get the bin number that an event is added to.
+    int GetEventIndex(int event) const;
+
+    /// Return the number of bits used for each bin index (16 or 32).
+    int GetIndexBits() const {return fPackedIndexes ? 16 : 32;}
+
+    /// Return true if the sums use the segmented reduction.
+    bool IsSegmented() const {return fSegmented;}
+
     /// Return the number of histogram bins that are accumulated.
     std::size_t GetSumCount() const {return fSums->size();}
 
@@ -78,6 +119,10 @@ public:
     /// A pointer to the validity flag.
     bool* GetSumsValidPointer();
 
+private:
+    /// Sort the entries by bin for the segmented reduction.
+    void BuildSegments();
+
 };
 
 // An MIT Style License
@@ -10,6 +10,7 @@
 #include "WeightUniformSpline.h"
 #include "WeightGeneralSpline.h"
 #include "WeightGraph.h"
+#include "WeightGridSpline.h"
 
 #include "CacheIndexedSums.h"
 
@@ -18,13 +19,17 @@
 
 #include "hemi/array.h"
 
-#include <map>
+#include <utility>
+#include <vector>
+#include <string>
 
 namespace Cache {
     class Manager;
 }
 
 class Parameter;
+class ParameterSet;
+class DialInputBuffer;
 
 /// Manage the cache calculations on the GPU.  This will work even when there
 /// isn't a GPU, but it's really slow on the CPU.  This is a singleton.
@@ -40,7 +45,11 @@ public:
 
     /// Build the cache and load it into the device.  This is used in
     /// Propagator.cpp to fill the constants needed to for the calculations.
-    static bool Build( SampleSet& sampleList, EventDialCache& eventDials);
+    /// The indexWidth is the width of the histogram bin indices ("int32",
+    /// "uint16" or "automatic", see Cache::IndexedSums::IndexWidth).  It is
+    /// only used when the cache is created.
+    static bool Build( SampleSet& sampleList, EventDialCache& eventDials,
+                       const std::string& indexWidth = "int32");
 
     /// Update the cache with the event and spline information.  This is
     /// called as part of Build, and can be called in other code if the cache
@@ -49,16 +58,24 @@ public:
     static bool Update( SampleSet& sampleList, EventDialCache& eventDials);
 
     /// Flag that the Cache::Manager internal caches must be updated from the
-    /// SampleSet and EventDialCache before it can be used.
+    /// SampleSet and EventDialCache before it can be used.  Masking a
+    /// parameter set doesn't need an update since the masks are applied by
+    /// the weight calculators.
     static void UpdateRequired();
 
     /// This returns the index of the parameter in the cache.  If the
-    /// parameter isn't defined, this will return a negative value.
+    /// parameter isn't defined, this will return a negative value.  This
+    /// searches the list of parameters, so it should not be used in a loop.
     static int ParameterIndex(const Parameter* fp);
 
     /// Return true if a GPU is available.
     static bool HasCUDA();
 
+    /// Set whether the weight calculators keep partial products so that the
+    /// calculators without a changed parameter are skipped (see
+    /// Cache::Weights).  This takes effect at the next Update.
+    static void SetUsePartialProducts(bool enable);
+
     /// Return the approximate allocated memory (e.g. on the GPU).
     std::size_t GetResidentMemory() const {return fTotalBytes;}
 
@@ -71,13 +88,33 @@ private:
             int uniformSplines, int uniformPoints,
             int generalSplines, int generalPoints,
             int graphs, int graphPoints,
-            int histBins, std::string spaceType);
+            int gridSplines, int gridPoints,
+            int histBins, std::string spaceType,
+            Cache::IndexedSums::IndexWidth indexWidth);
     static Manager* fSingleton;  // You get one guess...
     static bool fUpdateRequired; // Set to true when the cache needs an update.
+    static bool fUsePartialProducts;
+
+    // A flat table between the fit parameters and the parameter index used
+    // by the cache.  The parameters of a set are contiguous, so the index
+    // for parameter "p" of set "s" is
+    // ParameterIndexTable[ParameterSetOffset[s]+p] (negative if unused).
+    static std::vector<int> ParameterSetOffset;
+    static std::vector<int> ParameterIndexTable;
+
+    // The fit parameter (and its set) for each parameter index used by the
+    // cache.
+    static std::vector<const Parameter*> ParameterList;
+    static std::vector<const ParameterSet*> ParameterSetList;
 
-    // A map between the fit parameter pointers and the parameter index used
-    // by the fitter.
-    static std::map<const Parameter*, int> ParameterMap;
+    // The cache parameters used by the "Shift" dials, and their masks at
+    // the last update.  The shifts are folded into the initial weights, so
+    // changing one of these masks needs an update.
+    static std::vector<std::pair<int,bool>> ShiftMasks;
+    static bool ShiftMasksChanged();
+
+    // Return the index in the cache of input "i" of a dial.
+    static int InputParameterIndex(const DialInputBuffer& inputs, int i);
 
     /// Declare all of the actual GPU caches here.  There is one GPU, so this
     /// is the ONE place that everything is collected together.
@@ -106,12 +143,19 @@ private:
     /// The cache for the general splines
     std::unique_ptr<Cache::Weight::Graph> fGraphs;
 
+    /// The cache for the splines on a grid of several parameters
+    std::unique_ptr<Cache::Weight::GridSpline> fGridSplines;
+
     /// The cache for the summed histgram weights
     std::unique_ptr<Cache::IndexedSums> fHistogramsCache;
 
     // The rough size of all the caches.
     std::size_t fTotalBytes;
 
+    // The part of fTotalBytes used by the partial products of the weights
+    // cache.  It changes with each Update.
+    std::size_t fPartialProductBytes{0};
+
 public:
     virtual ~Manager() = default;
 
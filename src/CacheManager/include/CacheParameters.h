@@ -19,6 +19,7 @@ class Cache::Parameters {
 public:
     typedef hemi::Array<double> Values;
     typedef hemi::Array<double> Clamps;
+    typedef hemi::Array<short> Masks;
 
     // Returns true if this is compiled with a CUDA compiler
     static bool UsingCUDA();
@@ -36,6 +37,7 @@ public:
     Values& GetParameters() {return *fParameters;}
     Clamps& GetLowerClamps() {return *fLowerClamp;}
     Clamps& GetUpperClamps() {return *fUpperClamp;}
+    Masks& GetMasks() {return *fMasks;}
 
     /// Return the approximate allocated memory (e.g. on the GPU).
     std::size_t GetResidentMemory() const {return fTotalBytes;}
@@ -71,6 +73,16 @@ public:
     void SetLowerClamp(int parIdx, double value);
     void SetUpperClamp(int parIdx, double value);
 
+    /// Get whether parameter index i is masked in the host memory.
+    bool GetMasked(int parIdx) const;
+
+    /// Set whether parameter index i is masked in the host memory.  The
+    /// weight calculators give a neutral response for the entries of a
+    /// masked parameter, so masking doesn't require the cache to be
+    /// rebuilt.  This will invalidate the masks on the device when the mask
+    /// changes.
+    void SetMasked(int parIdx, bool value);
+
 private:
     std::size_t fTotalBytes;
 
@@ -89,6 +101,11 @@ private:
     ///  copied from the CPU to the GPU once, and are then constant.
     std::unique_ptr<Clamps> fLowerClamp;
     std::unique_ptr<Clamps> fUpperClamp;
+
+    /// Flag if the parameter is masked (e.g. the parameter set is masked for
+    /// propagation).  These are copied from the CPU to the GPU when they
+    /// change.
+    std::unique_ptr<Masks> fMasks;
 };
 
 // An MIT Style License
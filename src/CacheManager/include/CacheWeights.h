@@ -50,6 +50,25 @@ private:
     int fWeightCalculators{0};
     std::array<Cache::Weight::Base*,8> fWeightCalculator;
 
+    /// An array of partial products for each weight calculator (one value
+    /// per result).  When these are allocated, each calculator accumulates
+    /// into its own array, and only the calculators with a changed input
+    /// parameter are applied.  The results are then the initial values times
+    /// the partial products.  These never leave the GPU.  This is off by
+    /// default since it only pays when few parameters change between
+    /// iterations (e.g. Hesse, or a parameter scan).  When every parameter
+    /// moves, it adds a fill for each calculator and the product.
+    bool fUsePartialProducts{false};
+    int fPartialProductCount{0};
+    std::array<std::unique_ptr<Results>,8> fPartialProducts;
+
+    // Cache of whether the results are the product of the partial products.
+    bool fPartialProductsValid{false};
+
+    /// Free the partial products, and apply the calculators directly to the
+    /// results.
+    void ReleasePartialProducts();
+
 public:
     // Construct the class.  This should allocate all the memory on the host
     // and on the GPU.  The "results" are the total number of results to be
@@ -91,6 +110,23 @@ public:
         return index;
     }
 
+    /// Tell the weight calculators that all of the entries have been added.
+    virtual void Prepare();
+
+    /// Set whether the calculators accumulate into partial products so
+    /// that the unchanged calculators are skipped.  This costs one double per
+    /// result for each used calculator, and takes effect at the next
+    /// Prepare.
+    void SetUsePartialProducts(bool enable) {fUsePartialProducts = enable;}
+
+    /// Return the number of calculators with a partial product array.
+    int GetPartialProductCount() const {return fPartialProductCount;}
+
+    /// Return the approximate memory used by the partial products.
+    std::size_t GetPartialProductMemory() const {
+        return fPartialProductCount*GetResultCount()*sizeof(double);
+    }
+
     /// Calculate the results and save them for later use.  This copies the
     /// results from the GPU to the CPU.
     virtual bool Apply();
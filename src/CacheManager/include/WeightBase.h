@@ -7,6 +7,7 @@
 #include "hemi/array.h"
 
 #include <string>
+#include <vector>
 
 namespace Cache {
     namespace Weight {
@@ -19,8 +20,8 @@ namespace Cache {
 #define WEIGHT_BUFFER_FLOAT double
 
 /// A base class for the weight calculators.  This holds the pointer to the
-/// weights being accumulated, the input parameter values, and the name of the
-/// weight calculator.
+/// weights being accumulated, the input parameter values and masks, and the
+/// name of the weight calculator.
 class Cache::Weight::Base {
 public:
     // Construct the class.  This should allocate all the memory on the host
@@ -28,8 +29,10 @@ public:
     // which are managed by the EventWeights class.
     Base(std::string name,
          Cache::Weights::Results& weights,
-         Cache::Parameters::Values& parameters)
-        : fName(name), fWeights(weights), fParameters(parameters) {}
+         Cache::Parameters::Values& parameters,
+         Cache::Parameters::Masks& masks)
+        : fName(name), fWeights(weights), fParameters(parameters),
+          fMasks(masks) {}
 
     // Deconstruct the class.  This should deallocate all the memory
     // everyplace.
@@ -43,6 +46,35 @@ public:
     /// to modify the weights cache.
     virtual bool Apply() = 0;
 
+    /// Called once all of the entries have been added to the cache.  This
+    /// can rearrange the data (e.g. for the host kernels).
+    virtual void Prepare() {}
+
+    /// Set the array the weights are accumulated into.  A nullptr (the
+    /// default) accumulates into the event weight cache.  Cache::Weights
+    /// uses this to give each calculator its own array of partial products.
+    void SetOutput(Cache::Weights::Results* output) {fOutput = output;}
+
+    /// The array the weights are accumulated into by Apply.
+    Cache::Weights::Results& GetOutput() {
+        return (fOutput) ? *fOutput : fWeights;
+    }
+
+    /// Return true if the calculator has any entries.
+    bool IsUsed() const {return !fUsedParameters.empty();}
+
+    /// Return true if the weights calculated by Apply might be different
+    /// from the last time SetApplied was called (e.g. one of the parameters
+    /// used by the calculator has a new value, or has been masked).
+    bool IsDirty() const;
+
+    /// Record the parameter values and masks used by the last Apply.  The
+    /// calculator is clean until one of them changes.
+    void SetApplied();
+
+    /// Force the next Apply (e.g. the entries have been changed).
+    void SetDirty() {fApplied = false;}
+
     std::size_t GetResidentMemory() {return fTotalBytes;}
 
     std::string GetName() {return fName;}
@@ -58,8 +90,29 @@ protected:
     // Save the parameter cache reference for later use
     Cache::Parameters::Values& fParameters;
 
+    // Save the parameter mask reference for later use.  The entries for a
+    // masked parameter must have a neutral response (i.e. one).
+    Cache::Parameters::Masks& fMasks;
+
     std::size_t fTotalBytes{0};
 
+    /// Record that an entry uses the parameter.  This must be called by the
+    /// derived classes for every entry that is added.
+    void UseParameter(int parIndex);
+
+private:
+
+    // The array of partial products for this calculator (or nullptr)
+    Cache::Weights::Results* fOutput{nullptr};
+
+    // The parameters used by the entries, and their values and masks at the
+    // last Apply.  The flags are indexed by the parameter index.
+    std::vector<bool> fParameterUsed;
+    std::vector<int> fUsedParameters;
+    std::vector<double> fAppliedValues;
+    std::vector<short> fAppliedMasks;
+    bool fApplied{false};
+
 };
 
 // An MIT Style License
@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "WeightHostGroups.h"
 
 #include "hemi/array.h"
 
@@ -47,6 +48,9 @@ private:
     std::size_t    fGraphSpaceUsed;
     std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> fGraphSpace;
 
+    /// The graphs arranged for the host kernel (see WeightHostGroups.h).
+    Cache::Weight::HostGroups fHostGroups;
+
 public:
     // Construct the class.  This should allocate all the memory on the host
     // and on the GPU.  The "results" are the total number of results to be
@@ -57,6 +61,7 @@ public:
     // graphs.
     Graph(Cache::Weights::Results& results,
           Cache::Parameters::Values& parameters,
+          Cache::Parameters::Masks& masks,
           Cache::Parameters::Clamps& lowerClamps,
           Cache::Parameters::Clamps& upperClamps,
           std::size_t graphs,
@@ -73,10 +78,16 @@ public:
     // Apply the kernel to the event weights.
     virtual bool Apply() override;
 
+    /// Arrange the graphs for the host kernel once they are all added.
+    virtual void Prepare() override;
+
     /// Return the number of reserved graphs.
     std::size_t GetGraphsReserved() {return fGraphsReserved;}
 
     /// Return the number of graphs that were filled.
+    /// Once Prepare has arranged the graphs for the host kernel, this only
+    /// counts the graphs left out of the host groups, and the graph index
+    /// used by the accessors is for these graphs.
     std::size_t GetGraphsUsed() {return fGraphsUsed;}
 
     /// Return the number of elements reserved to hold space.
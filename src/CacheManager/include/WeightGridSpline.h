@@ -0,0 +1,140 @@
+#ifndef CacheWeightGridSpline_hxx_seen
+#define CacheWeightGridSpline_hxx_seen
+
+#include "CacheWeights.h"
+#include "WeightBase.h"
+
+#include "hemi/array.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace Cache {
+    namespace Weight {
+        class GridSpline;
+    }
+}
+
+/// A class to apply a grid spline (a dial depending on several parameters,
+/// interpolated on a grid of knots) to the cached event weights.  This will
+/// be used in Cache::Weights to run this type of reweighting on either the
+/// host or GPU.  See CalculateGridSpline for the data layout.
+class Cache::Weight::GridSpline:
+    public Cache::Weight::Base {
+private:
+    Cache::Parameters::Clamps& fLowerClamp;
+    Cache::Parameters::Clamps& fUpperClamp;
+
+    ///////////////////////////////////////////////////////////////////////
+    /// An array of indices into the results that go for each grid.  This is
+    /// copied from the host to the GPU once, and is then constant.
+    std::size_t fGridsReserved;
+    std::size_t fGridsUsed;
+    std::unique_ptr<hemi::Array<int>> fGridResult;
+
+    /// An array of indices into the parameters that go for each grid.  There
+    /// are GRID_SPLINE_MAX_DIMENSION entries per grid, and the unused ones are
+    /// set to the first parameter.  This is copied from the host to the GPU
+    /// once, and is then constant.
+    std::unique_ptr<hemi::Array<short>> fGridParameter;
+
+    /// An array of indices for the first data element of each grid.  This is
+    /// copied from the host to the GPU once, and is then constant.
+    std::unique_ptr<hemi::Array<int>> fGridIndex;
+
+    /// An array of the space to calculate the grids.  This is copied from the
+    /// host to the GPU once, and is then constant.
+    std::size_t    fGridSpaceReserved;
+    std::size_t    fGridSpaceUsed;
+    std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> fGridSpace;
+
+public:
+    // Construct the class.  This should allocate all the memory on the host
+    // and on the GPU.  The "results" are the total number of results to be
+    // calculated (one result per event, often >1E+6).  The "parameters" are
+    // the number of input parameters that are used (often ~1000).  The grids
+    // are the total number of grids used to calculate the results.  The
+    // space is the total space used by all of the grids.
+    GridSpline(Cache::Weights::Results& results,
+               Cache::Parameters::Values& parameters,
+               Cache::Parameters::Masks& masks,
+               Cache::Parameters::Clamps& lowerClamps,
+               Cache::Parameters::Clamps& upperClamps,
+               std::size_t grids,
+               std::size_t space);
+
+    // Deconstruct the class.  This should deallocate all the memory
+    // everyplace.
+    virtual ~GridSpline();
+
+    /// Reinitialize the cache.  This puts it into a state to be refilled, but
+    /// does not deallocate any memory.
+    virtual void Reset() override;
+
+    // Apply the kernel to the event weights.
+    virtual bool Apply() override;
+
+    /// Return the number of reserved grids.
+    std::size_t GetGridsReserved() {return fGridsReserved;}
+
+    /// Return the number of grids that were filled.
+    std::size_t GetGridsUsed() {return fGridsUsed;}
+
+    /// Return the number of elements reserved to hold space.
+    std::size_t GetGridSpaceReserved() const {return fGridSpaceReserved;}
+
+    /// Return the number of elements currently used to hold space.
+    std::size_t GetGridSpaceUsed() const {return fGridSpaceUsed;}
+
+    /// Add the data for the grid.  There must be one parameter index per
+    /// dimension of the grid.
+    void AddGrid(int resultIndex, const std::vector<int>& parIndices,
+                 const std::vector<double>& gridData);
+
+    // Get the number of dimensions of the grid at sIndex.
+    int GetGridDimensions(int sIndex);
+
+    // Get the index of the parameter for a dimension of the grid at sIndex.
+    int GetGridParameterIndex(int sIndex, int dim);
+
+    // Get the parameter value for a dimension of the grid at sIndex.
+    double GetGridParameter(int sIndex, int dim);
+
+    // Get the lower (upper) clamp for the grid at sIndex.
+    double GetGridLowerClamp(int sIndex);
+    double GetGridUpperClamp(int sIndex);
+
+    // Get a data element of the grid at sIndex.
+    double GetGridData(int sIndex, int i);
+
+};
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
@@ -0,0 +1,163 @@
+#ifndef WeightHostGroups_hxx_seen
+#define WeightHostGroups_hxx_seen
+
+#include "WeightBase.h"
+
+#include "hemi/array.h"
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Cache {
+    namespace Weight {
+        class HostGroups;
+    }
+}
+
+/// The spline (or graph) data of a weight calculator rearranged for the host
+/// kernels.  The splines of the same parameter with the same knot positions
+/// are put into a group.  Everything that depends only on the parameter
+/// value (the segment and the position in the segment) is then calculated
+/// once for the group, and the data of the splines in a group is stored
+/// knot major (all of the values for the first knot, then all of the values
+/// for the second knot, ...).  The splines are evaluated in batches of
+/// kBatch, and each value used by a batch is a contiguous load, so the
+/// loops over a batch are vectorized by the compiler instead of gathering
+/// one spline at a time.
+///
+/// The padding of the last batch is wasted, so the groups with fewer than
+/// kMinSplines splines are not built.  Those splines stay in the calculator
+/// and are evaluated one at a time by its generic kernel.
+///
+/// This is only used when the kernels run on the CPU.  The GPU keeps the
+/// layout in the calculator.
+class Cache::Weight::HostGroups {
+public:
+    /// The number of splines evaluated together.  The loops over a batch
+    /// have this fixed length (8 doubles is one AVX-512 register, or two
+    /// AVX2 registers).
+    static constexpr int kBatch = 8;
+
+    /// The smallest group that is built.  At most kBatch-1 padding splines
+    /// are added to a group, so this keeps the padding below 25%.
+    static constexpr int kMinSplines = 4*kBatch;
+
+    struct Group {
+        int parameter;       // The index of the parameter value.
+        int knotCount;       // The number of shared knot values.
+        int rows;            // The number of values for each spline.
+        int splines;         // The number of splines.
+        int stride;          // The number of splines rounded up to kBatch.
+        std::size_t knots;   // The offset of the shared knots.
+        std::size_t values;  // The offset of the values (rows*stride).
+        std::size_t results; // The offset of the result indices (stride).
+    };
+
+    struct Batch {
+        int group;           // The group of the batch.
+        int first;           // The first spline of the batch in the group.
+    };
+
+    HostGroups() = default;
+
+    /// Drop everything.
+    void Clear();
+
+    /// Add a spline.  The "knots" are the values shared by the splines of a
+    /// group (e.g. the knot positions), and the "values" are the values for
+    /// this spline.  The splines with the same parameter, the same knots
+    /// and the same number of values are grouped.  Nothing is usable until
+    /// Build is called.
+    void Add(int result, int parameter,
+             const WEIGHT_BUFFER_FLOAT* knots, int knotCount,
+             const WEIGHT_BUFFER_FLOAT* values, int rows);
+
+    /// Build the groups from the added splines.
+    void Build();
+
+    /// Return the number of added splines that are not in a group.
+    std::size_t GetUngroupedCount() const {return fUngrouped.size();}
+
+    /// Shrink the spline arrays of a calculator to the splines that are not
+    /// in a group (in the order they were added), so the grouped splines are
+    /// not stored twice.  The arrays are reallocated.  This returns the
+    /// space used by the kept splines.
+    std::size_t KeepUngrouped(
+        std::unique_ptr<hemi::Array<int>>& result,
+        std::unique_ptr<hemi::Array<short>>& parameter,
+        std::unique_ptr<hemi::Array<int>>& index,
+        std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>>& space) const;
+
+    /// Mark the layout as out of date (e.g. a knot was changed).  The
+    /// calculator then uses the generic kernel until it's built again.
+    void Invalidate() {fValid = false;}
+
+    bool IsValid() const {return fValid;}
+
+    std::size_t GetGroupCount() const {return fGroups.size();}
+    std::size_t GetBatchCount() const {return fBatches.size();}
+
+    /// The memory used by the layout.
+    std::size_t GetTotalBytes() const;
+
+    const Group* GetGroups() const {return fGroups.data();}
+    const Batch* GetBatches() const {return fBatches.data();}
+    const double* GetKnots() const {return fKnots.data();}
+    const WEIGHT_BUFFER_FLOAT* GetValues() const {return fValues.data();}
+    const int* GetResults() const {return fResults.data();}
+
+private:
+    // The splines added since the last build.
+    struct Entry {
+        int result;
+        int parameter;
+        int knotCount;
+        int rows;
+        std::size_t knots;
+        std::size_t values;
+    };
+    std::vector<Entry> fEntries;
+    std::vector<double> fEntryKnots;
+    std::vector<WEIGHT_BUFFER_FLOAT> fEntryValues;
+
+    // The added splines (in order) that are not in a group.
+    std::vector<int> fUngrouped;
+
+    // The layout.
+    bool fValid{false};
+    std::vector<Group> fGroups;
+    std::vector<Batch> fBatches;
+    std::vector<double> fKnots;
+    std::vector<WEIGHT_BUFFER_FLOAT> fValues;
+    std::vector<int> fResults;
+};
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
@@ -3,6 +3,7 @@
 
 #include "CacheWeights.h"
 #include "WeightBase.h"
+#include "WeightHostGroups.h"
 
 #include "hemi/array.h"
 
@@ -53,6 +54,9 @@ private:
     std::size_t    fSplineSpaceUsed;
     std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> fSplineSpace;
 
+    /// The splines arranged for the host kernel (see WeightHostGroups.h).
+    Cache::Weight::HostGroups fHostGroups;
+
 public:
     // A static method to return the number of knots that will be used by this
     // spline.
@@ -70,6 +74,7 @@ public:
     // knots for each spline, knots is 7000).
     MonotonicSpline(Cache::Weights::Results& results,
                     Cache::Parameters::Values& parameters,
+                    Cache::Parameters::Masks& masks,
                     Cache::Parameters::Clamps& lowerClamps,
                     Cache::Parameters::Clamps& upperClamps,
                     std::size_t splines, std::size_t knots,
@@ -86,12 +91,18 @@ public:
     // Apply the kernel to the event weights.
     virtual bool Apply() override;
 
+    /// Arrange the splines for the host kernel once they are all added.
+    virtual void Prepare() override;
+
     /// Return the number of parameters using a spline with uniform knots that
     /// are reserved.
     std::size_t GetSplinesReserved() {return fSplinesReserved;}
 
     /// Return the number of parameters using a spline with uniform knots that
     /// are used.
+    /// Once Prepare has arranged the splines for the host kernel, this only
+    /// counts the splines left out of the host groups, and the spline index
+    /// used by the accessors is for these splines.
     std::size_t GetSplinesUsed() {return fSplinesUsed;}
 
     /// Return the number of elements reserved to hold knots.
@@ -18,6 +18,7 @@
 // or CPU.)
 
 #include "hemi.h"
+#include "host_threads.h"
 
 namespace hemi
 {
@@ -26,7 +27,7 @@ namespace hemi
     #ifdef HEMI_DEV_CODE
     	return threadIdx.x + blockIdx.x * blockDim.x;
     #else
-    	return 0;
+    	return host_threads::threadContext().index;
     #endif
     }
 
@@ -36,7 +37,7 @@ namespace hemi
     #ifdef HEMI_DEV_CODE
     	return blockDim.x * gridDim.x;
     #else
-    	return 1;
+    	return host_threads::threadContext().count;
     #endif
     }
 
@@ -31,8 +31,20 @@ namespace hemi {
 	template <typename T>
 	HEMI_DEV_CALLABLE_INLINE
 	step_range<T> grid_stride_range(T begin, T end) {
+	#ifdef HEMI_DEV_CODE
 	    begin += hemi::globalThreadIndex();
 	    return range(begin, end).step(hemi::globalThreadCount());
+	#else
+	    // On the host, each thread takes a contiguous block of the range
+	    // (see host_threads.h).
+	    const T count = T(hemi::globalThreadCount());
+	    const T index = T(hemi::globalThreadIndex());
+	    const T size = (end > begin) ? end - begin : T(0);
+	    const T block = (size + count - 1)/count;
+	    const T first = begin + ((index*block < size) ? index*block : size);
+	    const T last = begin + (((index+1)*block < size) ? (index+1)*block : size);
+	    return range(first, last).step(T(1));
+	#endif
 	}
 	
 }
@@ -0,0 +1,98 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+// Host thread support for the "Hemi" CUDA Portable C/C++ Utilities.
+//
+// This is a GUNDAM addition, and is not part of the upstream Hemi
+// distribution (https://github.com/harrism/hemi).
+//
+///////////////////////////////////////////////////////////////////////////////
+// Without a GPU, a kernel launched with hemi::launch runs on the host.  If a
+// thread pool has been registered with hemi::host_threads::setThreadPool,
+// the kernel is run once on each thread of the pool, and
+// hemi::globalThreadIndex() and hemi::globalThreadCount() return the index
+// of the host thread and the size of the pool.  On the host,
+// hemi::grid_stride_range then gives each thread a contiguous block of the
+// range (instead of a strided one, which would make the threads share cache
+// lines).
+//
+// The thread pool is just a function running a job on all of its threads,
+// and returning once all of them are done, so this doesn't depend on a
+// particular implementation.
+//
+// Running on several threads gives up the bit-for-bit reproducibility of the
+// serial kernels.  A result can be updated by several threads (e.g. the
+// event weights with the Cache::Weight::HostGroups layout, see
+// CacheAtomicMult), and the order of the updates then depends on the
+// timing of the threads, so it changes from one run to the next.  The
+// histogram sums are reduced in a fixed order, but are summed in a
+// different order for each thread count.  The differences are rounding
+// errors (see tests/fast-tests/900CovarianceFitCheck-CacheManagerThreads.C).
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <functional>
+
+namespace hemi {
+    namespace host_threads {
+
+        /// Run job(iThread) for each iThread in [0, threadCount) and
+        /// return when all of the calls are done.
+        typedef std::function<void(const std::function<void(int)>&)> ThreadRunner;
+
+        struct ThreadPool {
+            int threadCount{1};
+            ThreadRunner runner{};
+        };
+
+        /// The pool used by the host launches.  One per library.
+        inline ThreadPool& threadPool() {
+            static ThreadPool pool;
+            return pool;
+        }
+
+        /// Register the pool used to run the host kernels.  A threadCount
+        /// smaller than 2 (or an empty runner) runs the kernels serially.
+        inline void setThreadPool(int threadCount, ThreadRunner runner) {
+            threadPool().threadCount = threadCount;
+            threadPool().runner = std::move(runner);
+        }
+
+        /// The position of the current host thread in the running kernel.
+        struct ThreadContext {
+            unsigned int index{0};
+            unsigned int count{1};
+        };
+
+        inline ThreadContext& threadContext() {
+            static thread_local ThreadContext context;
+            return context;
+        }
+
+        /// The number of threads the next launch will run on.  Launches from
+        /// inside a kernel are run serially on the calling thread.
+        inline int launchThreadCount() {
+            const ThreadPool& pool = threadPool();
+            if (pool.threadCount < 2 || !pool.runner
+                || threadContext().count > 1) return 1;
+            return pool.threadCount;
+        }
+
+        /// Run the kernel on each thread of the pool.
+        template <typename Kernel>
+        void parallelLaunch(const Kernel& kernel) {
+            const unsigned int count = launchThreadCount();
+            if (count < 2) {
+                kernel();
+                return;
+            }
+            threadPool().runner([&kernel, count](int iThread) {
+                ThreadContext& context = threadContext();
+                const ThreadContext saved = context;
+                context.index = iThread;
+                context.count = count;
+                kernel();
+                context = saved;
+            });
+        }
+    }
+}
@@ -1,15 +1,43 @@
 #ifndef CacheAtomicMult_h_seen
 #define CacheAtomicMult_h_seen
+
+#include <cstring>
+
 namespace {
     /// Do an atomic multiplication on the GPU.  On the GPU this uses
      /// compare-and-set.  On the CPU, this is just a multiplication (no
-     /// mutex, so not atomic).
+     /// mutex, so not atomic) when the kernel runs on a single thread.
     HEMI_DEV_CALLABLE_INLINE
     double CacheAtomicMult(double* address, const double v) {
 #ifndef HEMI_DEV_CODE
-        // When this isn't CUDA use a simple multiplication.
-        double old = *address;
-        *address = *address * v;
+        // When this isn't CUDA use a simple multiplication, unless the
+        // kernel is running on several host threads (see
+        // hemi/host_threads.h).
+        if (hemi::globalThreadCount() < 2) {
+            double old = *address;
+            *address = *address * v;
+            return old;
+        }
+        // The host threads work on contiguous blocks of the kernel range,
+        // but with the Cache::Weight::HostGroups layout a block holds the
+        // splines of many events, so any result can be updated by several
+        // threads at once.  The order of the multiplications then depends
+        // on the thread timing, and the result can change in the last bits
+        // from one run to the next (see hemi/host_threads.h).
+        unsigned long long int* address_as_ull =
+            reinterpret_cast<unsigned long long int*>(address);
+        unsigned long long int assumed
+            = __atomic_load_n(address_as_ull, __ATOMIC_RELAXED);
+        double old;
+        unsigned long long int updated;
+        do {
+            std::memcpy(&old, &assumed, sizeof(old));
+            const double result = old * v;
+            std::memcpy(&updated, &result, sizeof(updated));
+        } while (!__atomic_compare_exchange_n(address_as_ull, &assumed,
+                                              updated, true,
+                                              __ATOMIC_RELAXED,
+                                              __ATOMIC_RELAXED));
         return old;
 #else
         // When using CUDA use atomic compare-and-set to do an atomic
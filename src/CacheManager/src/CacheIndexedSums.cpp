@@ -1,6 +1,7 @@
 #include "CacheIndexedSums.h"
 #include "CacheWeights.h"
 
+#include <algorithm>
 #include <iostream>
 #include <exception>
 #include <cmath>
@@ -9,6 +10,7 @@
 #include <hemi/hemi_error.h>
 #include <hemi/launch.h>
 #include <hemi/grid_stride_range.h>
+#include <hemi/host_threads.h>
 
 #include "Logger.h"
 
@@ -18,16 +20,41 @@ LoggerInit([]{
 
 // The constructor
 Cache::IndexedSums::IndexedSums(Cache::Weights::Results& inputs,
-                                std::size_t bins)
+                                std::size_t bins,
+                                IndexWidth width)
     : fEventWeights(inputs) {
     if (inputs.size()<1) throw std::runtime_error("No bins to sum");
     if (bins<1) throw std::runtime_error("No bins to sum");
 
+    if (width == IndexWidth::Automatic) {
+        width = (bins <= kPackedBinLimit) ? IndexWidth::UInt16
+            : IndexWidth::Int32;
+    }
+    if (width == IndexWidth::UInt16 && kPackedBinLimit < bins) {
+        LogError << "Too many bins for 16 bit indices: " << bins
+                 << std::endl;
+        throw std::runtime_error("Too many bins for 16 bit indices");
+    }
+    fSegmented = (kSegmentedBinLimit < bins);
+
     LogInfo << "Cached IndexedSums -- bins reserved: "
            << bins
            << std::endl;
-    fTotalBytes += bins*sizeof(double);                   // fSums
-    fTotalBytes += fEventWeights.size()*sizeof(short);   // fIndexes;
+    LogInfo << "Cached IndexedSums -- "
+            << ((width == IndexWidth::UInt16) ? 16 : 32) << " bit indices"
+            << (fSegmented ? " with a segmented reduction" : "")
+            << std::endl;
+    fTotalBytes += 2*bins*sizeof(double);                 // fSums, fSums2
+    if (width == IndexWidth::UInt16) {
+        fTotalBytes += fEventWeights.size()*sizeof(std::uint16_t);
+    }
+    else {
+        fTotalBytes += fEventWeights.size()*sizeof(int);  // fIndexes
+    }
+    if (fSegmented) {
+        fTotalBytes += fEventWeights.size()*sizeof(int);  // fSortedEntries
+        fTotalBytes += (bins+1)*sizeof(int);              // fBinStarts
+    }
 
     LogInfo << "Cached IndexedSums -- approximate memory size: "
             << double(fTotalBytes)/1E+6
@@ -40,7 +67,14 @@ Cache::IndexedSums::IndexedSums(Cache::Weights::Results& inputs,
         // pinned.
         fSums = std::make_unique<hemi::Array<double>>(bins,true);
         fSums2 = std::make_unique<hemi::Array<double>>(bins,true);
-        fIndexes = std::make_unique<hemi::Array<short>>(fEventWeights.size(),false);
+        if (width == IndexWidth::UInt16) {
+            fPackedIndexes = std::make_unique<hemi::Array<std::uint16_t>>(
+                fEventWeights.size(),false);
+        }
+        else {
+            fIndexes = std::make_unique<hemi::Array<int>>(
+                fEventWeights.size(),false);
+        }
 
     }
     catch (std::bad_alloc&) {
@@ -76,7 +110,46 @@ void Cache::IndexedSums::SetEventIndex(int event, int bin) {
     if (fEventWeights.size() <= event) throw;
     if (bin < 0) throw;
     if (fSums->size() <= bin) throw;
-    fIndexes->hostPtr()[event] = bin;
+    if (fPackedIndexes) fPackedIndexes->hostPtr()[event] = bin;
+    else fIndexes->hostPtr()[event] = bin;
+    fSegmentsValid = false;
+}
+
+int Cache::IndexedSums::GetEventIndex(int event) const {
+    if (event < 0) throw;
+    if (fEventWeights.size() <= event) throw;
+    if (fPackedIndexes) return fPackedIndexes->hostPtr()[event];
+    return fIndexes->hostPtr()[event];
+}
+
+void Cache::IndexedSums::BuildSegments() {
+    const int entries = fEventWeights.size();
+    const int bins = fSums->size();
+    if (!fSortedEntries) {
+        fSortedEntries = std::make_unique<hemi::Array<int>>(entries,false);
+        fBinStarts = std::make_unique<hemi::Array<int>>(bins+1,false);
+    }
+
+    // A counting sort of the entries by bin.  Entries without a valid bin
+    // are left out.
+    int* starts = fBinStarts->hostPtr();
+    std::fill(starts, starts+bins+1, 0);
+    for (int i = 0; i < entries; ++i) {
+        const int bin = GetEventIndex(i);
+        if (bin < 0 || bins <= bin) continue;
+        ++starts[bin+1];
+    }
+    for (int b = 0; b < bins; ++b) starts[b+1] += starts[b];
+
+    std::vector<int> next(starts, starts+bins);
+    int* sorted = fSortedEntries->hostPtr();
+    for (int i = 0; i < entries; ++i) {
+        const int bin = GetEventIndex(i);
+        if (bin < 0 || bins <= bin) continue;
+        sorted[next[bin]++] = i;
+    }
+
+    fSegmentsValid = true;
 }
 
 double Cache::IndexedSums::GetSum(int i) {
@@ -130,22 +203,136 @@ namespace {
         }
     }
 
+    // Add the entries into their bins.  This is templated on the type of the
+    // bin indices.
+    template <typename Index>
+    HEMI_DEV_CALLABLE_INLINE
+    void IndexedSum(double* sums,
+                    double* sums2,
+                    const double* inputs,
+                    const Index* indexes,
+                    const int NP) {
+        for (int i : hemi::grid_stride_range(0,NP)) {
+            const double v = inputs[i];
+#ifdef HEMI_DEV_CODE
+            CacheAtomicAdd(&sums[indexes[i]],v);
+            CacheAtomicAdd(&sums2[indexes[i]],v*v);
+#else
+            sums[indexes[i]] += v;
+            sums2[indexes[i]] += v*v;
+#endif
+        }
+    }
+
     // A function to do the sums
     HEMI_KERNEL_FUNCTION(HEMIIndexedSumKernel,
                          double* sums,
                          double* sums2,
                          const double* inputs,
-                         const short* indexes,
+                         const int* indexes,
                          const int NP) {
+        IndexedSum(sums, sums2, inputs, indexes, NP);
+    }
+
+    // A function to do the sums with 16 bit indices
+    HEMI_KERNEL_FUNCTION(HEMIPackedIndexedSumKernel,
+                         double* sums,
+                         double* sums2,
+                         const double* inputs,
+                         const std::uint16_t* indexes,
+                         const int NP) {
+        IndexedSum(sums, sums2, inputs, indexes, NP);
+    }
+
+    // Sum the entries into the partial histogram of the current host
+    // thread.  Each thread sums its block of entries into its own partial
+    // histogram, so there is no need for atomic operations.
+    template <typename Index>
+    HEMI_DEV_CALLABLE_INLINE
+    void IndexedPartialSum(double* partialSums,
+                           double* partialSums2,
+                           const double* inputs,
+                           const Index* indexes,
+                           const int NP,
+                           const int bins) {
+        double* sums = partialSums + hemi::globalThreadIndex()*bins;
+        double* sums2 = partialSums2 + hemi::globalThreadIndex()*bins;
+        for (int b = 0; b < bins; ++b) {
+            sums[b] = 0.0;
+            sums2[b] = 0.0;
+        }
         for (int i : hemi::grid_stride_range(0,NP)) {
             const double v = inputs[i];
-#ifdef HEMI_DEV_CODE
-            CacheAtomicAdd(&sums[indexes[i]],v);
-            CacheAtomicAdd(&sums2[indexes[i]],v*v);
-#else
             sums[indexes[i]] += v;
             sums2[indexes[i]] += v*v;
-#endif
+        }
+    }
+
+    // A function to do the sums on several host threads.
+    HEMI_KERNEL_FUNCTION(HEMIIndexedPartialSumKernel,
+                         double* partialSums,
+                         double* partialSums2,
+                         const double* inputs,
+                         const int* indexes,
+                         const int NP,
+                         const int bins) {
+        IndexedPartialSum(partialSums, partialSums2, inputs, indexes,
+                          NP, bins);
+    }
+
+    // A function to do the sums on several host threads with 16 bit
+    // indices.
+    HEMI_KERNEL_FUNCTION(HEMIPackedIndexedPartialSumKernel,
+                         double* partialSums,
+                         double* partialSums2,
+                         const double* inputs,
+                         const std::uint16_t* indexes,
+                         const int NP,
+                         const int bins) {
+        IndexedPartialSum(partialSums, partialSums2, inputs, indexes,
+                          NP, bins);
+    }
+
+    // A function to add the partial histograms of the threads.
+    HEMI_KERNEL_FUNCTION(HEMIReducePartialSumsKernel,
+                         double* sums,
+                         double* sums2,
+                         const double* partialSums,
+                         const double* partialSums2,
+                         const int bins,
+                         const int parts) {
+        for (int b : hemi::grid_stride_range(0,bins)) {
+            double s = 0.0;
+            double s2 = 0.0;
+            for (int p = 0; p < parts; ++p) {
+                s += partialSums[p*bins + b];
+                s2 += partialSums2[p*bins + b];
+            }
+            sums[b] = s;
+            sums2[b] = s2;
+        }
+    }
+
+    // A function to do the sums with the entries sorted by bin.  Each bin is
+    // summed by one thread, so the sums don't need to be reset, and there is
+    // no need for atomic operations.
+    HEMI_KERNEL_FUNCTION(HEMISegmentedSumKernel,
+                         double* sums,
+                         double* sums2,
+                         const double* inputs,
+                         const int* sortedEntries,
+                         const int* binStarts,
+                         const int bins) {
+        for (int b : hemi::grid_stride_range(0,bins)) {
+            double s = 0.0;
+            double s2 = 0.0;
+            for (int j = binStarts[b]; j < binStarts[b+1]; ++j) {
+                const double v = inputs[sortedEntries[j]];
+                s += v;
+                s2 += v*v;
+            }
+            sums[b] = s;
+            sums2[b] = s2;
         }
     }
 
@@ -155,6 +342,74 @@ bool Cache::IndexedSums::Apply() {
     // Mark the results has having changed.
     fSumsValid = false;
 
+    // Without a GPU, the kernels can run on several host threads (see
+    // hemi/host_threads.h).
+    int threads = 1;
+#ifndef HEMI_CUDA_COMPILER
+    threads = hemi::host_threads::launchThreadCount();
+#endif
+
+    // Use the segmented reduction for very large binnings, and when the
+    // partial histograms of the host threads would be larger than the
+    // entries.
+    if (fSegmented
+        || (threads > 1
+            && fEventWeights.size() < threads*fSums->size())) {
+        if (!fSegmentsValid) BuildSegments();
+        HEMISegmentedSumKernel segmentedSumKernel;
+        hemi::launch(segmentedSumKernel,
+                     fSums->writeOnlyPtr(),
+                     fSums2->writeOnlyPtr(),
+                     fEventWeights.readOnlyPtr(),
+                     fSortedEntries->readOnlyPtr(),
+                     fBinStarts->readOnlyPtr(),
+                     fSums->size());
+        return true;
+    }
+
+#ifndef HEMI_CUDA_COMPILER
+    // With several host threads, the bins are summed per thread and
+    // reduced.
+    if (threads > 1) {
+        const std::size_t partialSize = threads*fSums->size();
+        if (fPartialSums.size() != partialSize) {
+            fPartialSums.resize(partialSize);
+            fPartialSums2.resize(partialSize);
+        }
+
+        if (fPackedIndexes) {
+            HEMIPackedIndexedPartialSumKernel partialSumKernel;
+            hemi::launch(partialSumKernel,
+                         fPartialSums.data(),
+                         fPartialSums2.data(),
+                         fEventWeights.readOnlyPtr(),
+                         fPackedIndexes->readOnlyPtr(),
+                         fEventWeights.size(),
+                         fSums->size());
+        }
+        else {
+            HEMIIndexedPartialSumKernel partialSumKernel;
+            hemi::launch(partialSumKernel,
+                         fPartialSums.data(),
+                         fPartialSums2.data(),
+                         fEventWeights.readOnlyPtr(),
+                         fIndexes->readOnlyPtr(),
+                         fEventWeights.size(),
+                         fSums->size());
+        }
+
+        HEMIReducePartialSumsKernel reduceKernel;
+        hemi::launch(reduceKernel,
+                     fSums->writeOnlyPtr(),
+                     fSums2->writeOnlyPtr(),
+                     (const double*) fPartialSums.data(),
+                     (const double*) fPartialSums2.data(),
+                     fSums->size(),
+                     threads);
+        return true;
+    }
+#endif
+
     HEMIResetKernel resetKernel;
     hemi::launch(resetKernel,
                  fSums->writeOnlyPtr(),
@@ -166,13 +421,24 @@ bool Cache::IndexedSums::Apply() {
                  0.0,
                  fSums2->size());
 
-    HEMIIndexedSumKernel indexedSumKernel;
-    hemi::launch(indexedSumKernel,
-                 fSums->writeOnlyPtr(),
-                 fSums2->writeOnlyPtr(),
-                 fEventWeights.readOnlyPtr(),
-                 fIndexes->readOnlyPtr(),
-                 fEventWeights.size());
+    if (fPackedIndexes) {
+        HEMIPackedIndexedSumKernel indexedSumKernel;
+        hemi::launch(indexedSumKernel,
+                     fSums->writeOnlyPtr(),
+                     fSums2->writeOnlyPtr(),
+                     fEventWeights.readOnlyPtr(),
+                     fPackedIndexes->readOnlyPtr(),
+                     fEventWeights.size());
+    }
+    else {
+        HEMIIndexedSumKernel indexedSumKernel;
+        hemi::launch(indexedSumKernel,
+                     fSums->writeOnlyPtr(),
+                     fSums2->writeOnlyPtr(),
+                     fEventWeights.readOnlyPtr(),
+                     fIndexes->readOnlyPtr(),
+                     fEventWeights.size());
+    }
 
     // Synchronization prevents the GPU from running in parallel with the CPU,
     // so it can make the whole program a little slower.  In practice, the
@@ -9,7 +9,9 @@
 #include "WeightUniformSpline.h"
 #include "WeightGeneralSpline.h"
 #include "WeightGraph.h"
+#include "WeightGridSpline.h"
 #include "CacheIndexedSums.h"
+#include <hemi/host_threads.h>
 
 #include "ParameterSet.h"
 #include "GundamGlobals.h"
@@ -21,10 +23,12 @@
 #include "CompactSpline.h"
 #include "MonotonicSpline.h"
 #include "LightGraph.h"
+#include "GridSpline.h"
 #include "Shift.h"
 
 #include <memory>
-#include <set>
+#include <vector>
+#include <algorithm>
 
 LoggerInit([]{
   Logger::setUserHeaderStr("[Cache::Manager]");
@@ -32,7 +36,47 @@ LoggerInit([]{
 
 Cache::Manager* Cache::Manager::fSingleton = nullptr;
 bool Cache::Manager::fUpdateRequired = true;
-std::map<const Parameter*, int> Cache::Manager::ParameterMap;
+bool Cache::Manager::fUsePartialProducts = false;
+std::vector<int> Cache::Manager::ParameterSetOffset;
+std::vector<int> Cache::Manager::ParameterIndexTable;
+std::vector<const Parameter*> Cache::Manager::ParameterList;
+std::vector<const ParameterSet*> Cache::Manager::ParameterSetList;
+std::vector<std::pair<int,bool>> Cache::Manager::ShiftMasks;
+
+namespace {
+    // The types of dial that are handled by the cache.
+    enum class DialKind : unsigned char {
+        Unsupported,
+        Norm,
+        CompactSpline,
+        MonotonicSpline,
+        UniformSpline,
+        GeneralSpline,
+        LightGraph,
+        GridSpline,
+        Shift,
+    };
+
+    DialKind FindDialKind(const DialBase* dial) {
+        if (dynamic_cast<const Norm*>(dial)) return DialKind::Norm;
+        if (dynamic_cast<const CompactSpline*>(dial)) {
+            return DialKind::CompactSpline;
+        }
+        if (dynamic_cast<const MonotonicSpline*>(dial)) {
+            return DialKind::MonotonicSpline;
+        }
+        if (dynamic_cast<const UniformSpline*>(dial)) {
+            return DialKind::UniformSpline;
+        }
+        if (dynamic_cast<const GeneralSpline*>(dial)) {
+            return DialKind::GeneralSpline;
+        }
+        if (dynamic_cast<const LightGraph*>(dial)) return DialKind::LightGraph;
+        if (dynamic_cast<const GridSpline*>(dial)) return DialKind::GridSpline;
+        if (dynamic_cast<const Shift*>(dial)) return DialKind::Shift;
+        return DialKind::Unsupported;
+    }
+}
 
 Cache::Manager::Manager(int events, int parameters,
                         int norms,
@@ -41,7 +85,9 @@ Cache::Manager::Manager(int events, int parameters,
                         int uniformSplines, int uniformPoints,
                         int generalSplines, int generalPoints,
                         int graphs, int graphPoints,
-                        int histBins, std::string spaceOption) {
+                        int gridSplines, int gridPoints,
+                        int histBins, std::string spaceOption,
+                        Cache::IndexedSums::IndexWidth indexWidth) {
     LogInfo  << "Creating cache manager" << std::endl;
 
     fTotalBytes = 0;
@@ -55,6 +101,7 @@ Cache::Manager::Manager(int events, int parameters,
         fNormalizations = std::make_unique<Cache::Weight::Normalization>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   norms);
         fWeightsCache->AddWeightCalculator(fNormalizations.get());
         fTotalBytes += fNormalizations->GetResidentMemory();
@@ -62,6 +109,7 @@ Cache::Manager::Manager(int events, int parameters,
         fCompactSplines = std::make_unique<Cache::Weight::CompactSpline>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   fParameterCache->GetLowerClamps(),
                                   fParameterCache->GetUpperClamps(),
                                   compactSplines, compactPoints,
@@ -72,6 +120,7 @@ Cache::Manager::Manager(int events, int parameters,
         fMonotonicSplines = std::make_unique<Cache::Weight::MonotonicSpline>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   fParameterCache->GetLowerClamps(),
                                   fParameterCache->GetUpperClamps(),
                                   monotonicSplines, monotonicPoints,
@@ -82,6 +131,7 @@ Cache::Manager::Manager(int events, int parameters,
         fUniformSplines = std::make_unique<Cache::Weight::UniformSpline>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   fParameterCache->GetLowerClamps(),
                                   fParameterCache->GetUpperClamps(),
                                   uniformSplines, uniformPoints,
@@ -92,6 +142,7 @@ Cache::Manager::Manager(int events, int parameters,
         fGeneralSplines = std::make_unique<Cache::Weight::GeneralSpline>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   fParameterCache->GetLowerClamps(),
                                   fParameterCache->GetUpperClamps(),
                                   generalSplines, generalPoints,
@@ -102,14 +153,26 @@ Cache::Manager::Manager(int events, int parameters,
         fGraphs = std::make_unique<Cache::Weight::Graph>(
                                   fWeightsCache->GetWeights(),
                                   fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
                                   fParameterCache->GetLowerClamps(),
                                   fParameterCache->GetUpperClamps(),
                                   graphs, graphPoints);
         fWeightsCache->AddWeightCalculator(fGraphs.get());
         fTotalBytes += fGraphs->GetResidentMemory();
+
+        fGridSplines = std::make_unique<Cache::Weight::GridSpline>(
+                                  fWeightsCache->GetWeights(),
+                                  fParameterCache->GetParameters(),
+                                  fParameterCache->GetMasks(),
+                                  fParameterCache->GetLowerClamps(),
+                                  fParameterCache->GetUpperClamps(),
+                                  gridSplines, gridPoints);
+        fWeightsCache->AddWeightCalculator(fGridSplines.get());
+        fTotalBytes += fGridSplines->GetResidentMemory();
+
         fHistogramsCache = std::make_unique<Cache::IndexedSums>(
                                   fWeightsCache->GetWeights(),
-                                  histBins);
+                                  histBins, indexWidth);
         fTotalBytes += fHistogramsCache->GetResidentMemory();
 
     }
@@ -129,8 +192,15 @@ bool Cache::Manager::HasCUDA() {
     return Cache::Parameters::UsingCUDA();
 }
 
+void Cache::Manager::SetUsePartialProducts(bool enable) {
+    if (fUsePartialProducts == enable) return;
+    fUsePartialProducts = enable;
+    fUpdateRequired = true;
+}
+
 bool Cache::Manager::Build( SampleSet& sampleList,
-                            EventDialCache& eventDials) {
+                            EventDialCache& eventDials,
+                            const std::string& indexWidth) {
     LogInfo << "Build the internal caches " << std::endl;
 
     /// Zero everything before counting the amount of space needed for the
@@ -146,38 +216,69 @@ bool Cache::Manager::Build( SampleSet& sampleList,
     int generalPoints = 0;
     int graphs = 0;
     int graphPoints = 0;
+    int gridSplines = 0;
+    int gridPoints = 0;
     int norms = 0;
     int shifts = 0;
-    Cache::Manager::ParameterMap.clear();
-
-    /// Find the amount of space needed for the cache.
-    std::set<const Parameter*> usedParameters;
-
-    std::map<std::string, int> useCount;
-    for (EventDialCache::CacheEntry& elem : eventDials.getCache()) {
+    Cache::Manager::ParameterSetOffset.clear();
+    Cache::Manager::ParameterIndexTable.clear();
+    Cache::Manager::ParameterList.clear();
+    Cache::Manager::ParameterSetList.clear();
+
+    /// Find the amount of space needed for the cache.  The used parameters
+    /// are found in the order of their first use, and flagged for each
+    /// parameter set.
+    std::vector<DialInputBuffer::ParameterReference> usedParameters;
+    std::vector<std::vector<bool>> parameterUsed;
+    for (std::size_t iEntry = 0; iEntry < eventDials.getNbEvents(); ++iEntry) {
+        EventDialCache::CacheEntry elem = eventDials.getCacheEntry(iEntry);
         if (elem.event->getIndices().bin < 0) {
             throw std::runtime_error("Caching event that isn't used");
         }
         ++events;
-        for( auto& dialResponseCache : elem.dialResponseCacheList) {
+        for (std::size_t iDial = 0; iDial < elem.getNbDials(); ++iDial) {
+            DialInterface& dialInterface = elem.getDialInterface(iDial);
             // This is depending behavior that is not guarranteed, but which
             // is probably valid because of the particular usage.
             // Specifically, it depends on the vector of Parameter objects
             // not being moved.  This happens after the vectors are "closed",
             // so it is probably safe, but this isn't good.  The particular
             // usage is forced do to an API change.
-            const Parameter* fp = &(dialResponseCache.dialInterface.getInputBufferRef()->getParameter(0));
-            usedParameters.insert(fp);
-            ++useCount[fp->getFullTitle()];
+            DialInputBuffer* dialInputs = dialInterface.getInputBufferRef();
+            for (int i = 0; i < dialInputs->getBufferSize(); ++i) {
+                const DialInputBuffer::ParameterReference& ref
+                    = dialInputs->getInputParameterIndicesList()[i];
+                if (parameterUsed.size() <= ref.parSetIndex) {
+                    parameterUsed.resize(ref.parSetIndex+1);
+                }
+                std::vector<bool>& used = parameterUsed[ref.parSetIndex];
+                if (used.empty()) {
+                    used.resize(dialInputs->getParameterSet(i)
+                                .getParameterList().size(), false);
+                }
+                if (used[ref.parIndex]) continue;
+                used[ref.parIndex] = true;
+                usedParameters.push_back(ref);
+                Cache::Manager::ParameterList.push_back(
+                    &(dialInputs->getParameter(i)));
+                Cache::Manager::ParameterSetList.push_back(
+                    &(dialInputs->getParameterSet(i)));
+            }
 
-            DialBase* dial = dialResponseCache.dialInterface.getDialBaseRef();
+            DialBase* dial = dialInterface.getDialBaseRef();
             std::string dialType = dial->getDialTypeName();
             if (dialType.find("Norm") == 0) {
                 ++norms;
             }
             else if (dialType.find("GeneralSpline") == 0) {
                 ++generalSplines;
-                generalPoints += dial->getDialData().size();
+                // The knots may be on a grid shared with other splines, but
+                // the cache stores them with each spline.
+                const GeneralSpline* generalSpline
+                    = dynamic_cast<const GeneralSpline*>(dial);
+                generalPoints += (generalSpline)
+                    ? generalSpline->getFullSplineDataSize()
+                    : dial->getDialData().size();
             }
             else if (dialType.find("UniformSpline") == 0) {
                 ++uniformSplines;
@@ -195,6 +296,10 @@ bool Cache::Manager::Build( SampleSet& sampleList,
                 ++graphs;
                 graphPoints += dial->getDialData().size();
             }
+            else if (dialType.find("GridSpline") == 0) {
+                ++gridSplines;
+                gridPoints += dial->getDialData().size();
+            }
             else if (dialType.find("Shift") == 0) {
                 ++shifts;
             }
@@ -207,6 +312,22 @@ bool Cache::Manager::Build( SampleSet& sampleList,
         }
     }
 
+    // Fill the flat table from the parameter set and parameter indices to
+    // the parameter index in the cache.  The parameters of a set are
+    // contiguous in the table.
+    int tableSize = 0;
+    for (const std::vector<bool>& used : parameterUsed) {
+        Cache::Manager::ParameterSetOffset.push_back(tableSize);
+        tableSize += used.size();
+    }
+    Cache::Manager::ParameterIndexTable.resize(tableSize, -1);
+    for (std::size_t i = 0; i < usedParameters.size(); ++i) {
+        const DialInputBuffer::ParameterReference& ref = usedParameters[i];
+        Cache::Manager::ParameterIndexTable[
+            Cache::Manager::ParameterSetOffset[ref.parSetIndex]
+            + ref.parIndex] = i;
+    }
+
     // Count the total number of histogram cells.
     int histCells = 0;
     for(const Sample& sample : sampleList.getSampleList() ){
@@ -218,7 +339,7 @@ bool Cache::Manager::Build( SampleSet& sampleList,
     }
 
     /// Summarize the space and get the cache memory.
-    int parameters = int(usedParameters.size());
+    int parameters = int(Cache::Manager::ParameterList.size());
     LogInfo  << "Cache for " << events << " events --"
             << " using " << parameters << " parameters"
             << std::endl;
@@ -237,6 +358,9 @@ bool Cache::Manager::Build( SampleSet& sampleList,
     LogInfo  << "    Graphs: " << graphs
             << " (" << 1.0*graphs/events << " per event)"
             << std::endl;
+    LogInfo  << "    Grid splines: " << gridSplines
+            << " (" << 1.0*gridSplines/events << " per event)"
+            << std::endl;
     LogInfo  << "    Normalizations: " << norms
             <<" ("<< 1.0*norms/events <<" per event)"
             << std::endl;
@@ -285,6 +409,14 @@ bool Cache::Manager::Build( SampleSet& sampleList,
                 << " (" << 1.0*graphPoints/graphs << " points per graph)"
                 << std::endl;
     }
+    if (gridSplines > 0) {
+        LogInfo  << "    Grid spline cache uses "
+                << gridPoints << " control points --"
+                << " (" << 1.0*gridPoints/gridSplines
+                << " points per grid)"
+                << " for " << gridSplines << " grids"
+                << std::endl;
+    }
 
     // Try to allocate the Cache::Manager memory (including for the GPU if
     // it's being used).
@@ -295,6 +427,21 @@ bool Cache::Manager::Build( SampleSet& sampleList,
             LogInfo << "    GPU Not enabled with Cache::Manager"
                       << std::endl;
         }
+        Cache::IndexedSums::IndexWidth width;
+        if (indexWidth == "int32") {
+            width = Cache::IndexedSums::IndexWidth::Int32;
+        }
+        else if (indexWidth == "uint16") {
+            width = Cache::IndexedSums::IndexWidth::UInt16;
+        }
+        else if (indexWidth == "automatic") {
+            width = Cache::IndexedSums::IndexWidth::Automatic;
+        }
+        else {
+            LogError << "Invalid cache manager index width: " << indexWidth
+                     << " (int32, uint16 or automatic)" << std::endl;
+            throw std::runtime_error("Invalid cache manager index width");
+        }
         fSingleton = new Manager(events,parameters,
                                  norms,
                                  compactSplines,compactPoints,
@@ -302,8 +449,24 @@ bool Cache::Manager::Build( SampleSet& sampleList,
                                  uniformSplines,uniformPoints,
                                  generalSplines,generalPoints,
                                  graphs, graphPoints,
+                                 gridSplines, gridPoints,
                                  histCells,
-                                 "space");
+                                 "space", width);
+
+        // Without a GPU, the kernels run on the host.  Share them between
+        // the GUNDAM threads (see hemi/host_threads.h).  The results are
+        // then only reproducible up to rounding errors.
+        const int threads = GundamGlobals::getParallelWorker().getNbThreads();
+        if (!Cache::Manager::HasCUDA() && threads > 1) {
+            LogInfo << "    Host kernels run on " << threads << " threads"
+                    << " (not bit-for-bit reproducible)"
+                    << std::endl;
+            hemi::host_threads::setThreadPool(
+                threads,
+                [](const std::function<void(int)>& job) {
+                    GundamGlobals::getParallelWorker().runJob(job);
+                });
+        }
     }
 
     // In case the cache isn't allocated (usually because it's turned off on
@@ -327,7 +490,7 @@ void Cache::Manager::UpdateRequired() {
 
 bool Cache::Manager::Update( SampleSet& sampleList,
                              EventDialCache& eventDials) {
-    if (not fUpdateRequired) return true;
+    if (not fUpdateRequired and not ShiftMasksChanged()) return true;
 
     // This is the updated that is required!
     fUpdateRequired = false;
@@ -348,9 +511,40 @@ bool Cache::Manager::Update( SampleSet& sampleList,
     Cache::Manager::Get()->GetWeightsCache().Reset();
 
     int usedResults = 0;
+    std::vector<bool> shiftParameters(ParameterList.size(), false);
+
+    // Find the type of every dial before adding them to the caches.  This
+    // is the expensive part of the loop over the dials, so it's shared
+    // between the threads.  The dials of entry i start at dialOffset[i].
+    const std::size_t entries = eventDials.getNbEvents();
+    std::vector<std::size_t> dialOffset(entries+1, 0);
+    for (std::size_t iEntry = 0; iEntry < entries; ++iEntry) {
+        dialOffset[iEntry+1] = dialOffset[iEntry]
+            + eventDials.getCacheEntry(iEntry).getNbDials();
+    }
+    std::vector<DialKind> dialKinds(dialOffset[entries]);
+    GundamGlobals::getParallelWorker().runJob(
+        [&](int iThread) {
+            int nThreads = GundamGlobals::getParallelWorker().getNbThreads();
+            if (iThread < 0) {iThread = 0; nThreads = 1;}
+            const std::size_t begin = entries*iThread/nThreads;
+            const std::size_t end = entries*(iThread+1)/nThreads;
+            for (std::size_t iEntry = begin; iEntry < end; ++iEntry) {
+                EventDialCache::CacheEntry elem
+                    = eventDials.getCacheEntry(iEntry);
+                for (std::size_t iDial = 0; iDial < elem.getNbDials();
+                     ++iDial) {
+                    dialKinds[dialOffset[iEntry]+iDial] = FindDialKind(
+                        elem.getDialInterface(iDial).getDialBaseRef());
+                }
+            }
+        });
 
-    // Add the dials in the EventDialCache to the internal cache.
-    for (EventDialCache::CacheEntry& elem : eventDials.getCache()) {
+    // Add the dials in the EventDialCache to the internal cache.  The
+    // results, and the entries of the weight calculators, are filled in the
+    // order of the EventDialCache.
+    for (std::size_t iEntry = 0; iEntry < entries; ++iEntry) {
+        EventDialCache::CacheEntry elem = eventDials.getCacheEntry(iEntry);
         // Skip events that are not in a bin.
         if (elem.event->getIndices().bin < 0) continue;
         Event& event = *elem.event;
@@ -371,46 +565,29 @@ bool Cache::Manager::Update( SampleSet& sampleList,
         // Get the initial value for this event and save it.
         double initialEventWeight = event.getWeights().base;
 
-        // Add each dial for the event to the GPU caches.
-        for( auto& dialElem : elem.dialResponseCacheList ){
-            DialInputBuffer* dialInputs = dialElem.dialInterface.getInputBufferRef();
-
-            // Check if this dial is used at all.
-            if (dialInputs->isMasked()){ continue; }
-
-            // Make sure all of the used parameters are in the parameter
-            // map.
-            for (std::size_t i = 0; i < dialInputs->getBufferSize(); ++i) {
-                // Find the index (or allocate a new one) for the dial
-                // parameter.  This only works for 1D dials.
-                const Parameter* fp
-                    = &(dialElem.dialInterface.getInputBufferRef()
-                        ->getParameter(i));
-                auto parMapIt = Cache::Manager::ParameterMap.find(fp);
-                if (parMapIt == Cache::Manager::ParameterMap.end()) {
-                    Cache::Manager::ParameterMap[fp]
-                        = int(Cache::Manager::ParameterMap.size());
-                }
-            }
+        // Add each dial for the event to the GPU caches.  The masked dials
+        // are added too since the masks are applied by the weight
+        // calculators (see Cache::Manager::Fill).
+        for (std::size_t iDial = 0; iDial < elem.getNbDials(); ++iDial) {
+            DialInterface& dialInterface = elem.getDialInterface(iDial);
+            DialInputBuffer* dialInputs = dialInterface.getInputBufferRef();
 
             // Apply the mirroring for the parameters
-          for (std::size_t i = 0; i < dialInputs->getBufferSize(); ++i) {
-            const Parameter* fp = &(dialInputs->getParameter(i));
-            auto& bounds = dialInputs->getMirrorEdges(i);
-            if( not std::isnan(bounds.minValue) ){
-              int parIndex = Cache::Manager::ParameterMap[fp];
-              Cache::Manager::Get()->GetParameterCache().SetLowerMirror(parIndex, bounds.minValue);
-              Cache::Manager::Get()->GetParameterCache().SetUpperMirror(parIndex, bounds.minValue+bounds.range);
+            for (std::size_t i = 0; i < dialInputs->getBufferSize(); ++i) {
+                auto& bounds = dialInputs->getMirrorEdges(i);
+                if (std::isnan(bounds.minValue)) continue;
+                int parIndex = InputParameterIndex(*dialInputs,i);
+                Cache::Manager::Get()->GetParameterCache()
+                    .SetLowerMirror(parIndex, bounds.minValue);
+                Cache::Manager::Get()->GetParameterCache()
+                    .SetUpperMirror(parIndex, bounds.minValue+bounds.range);
             }
 
-          }
-
             // Apply the clamps to the parameter range
             for (std::size_t i = 0; i < dialInputs->getBufferSize(); ++i) {
-                const Parameter* fp = &(dialInputs->getParameter(i));
                 const DialResponseSupervisor* resp
-                    = dialElem.dialInterface.getResponseSupervisorRef();
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                    = dialInterface.getResponseSupervisorRef();
+                int parIndex = InputParameterIndex(*dialInputs,i);
                 double minResponse = 0.0;
                 if (std::isfinite(resp->getMinResponse())) {
                     minResponse = resp->getMinResponse();
@@ -423,81 +600,80 @@ bool Cache::Manager::Update( SampleSet& sampleList,
             }
 
             // Add the dial information to the appropriate caches
-            int dialUsed = 0;
-            const DialBase* baseDial = dialElem.dialInterface.getDialBaseRef();
-            const Norm* normDial = dynamic_cast<const Norm*>(baseDial);
-            if (normDial) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+            const DialBase* baseDial = dialInterface.getDialBaseRef();
+            switch (dialKinds[dialOffset[iEntry]+iDial]) {
+            case DialKind::Norm:
                 Cache::Manager::Get()
                     ->fNormalizations
-                    ->ReserveNorm(resultIndex,parIndex);
-            }
-            const CompactSpline* compactSpline
-                = dynamic_cast<const CompactSpline*>(baseDial);
-            if (compactSpline) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                    ->ReserveNorm(resultIndex,
+                                  InputParameterIndex(*dialInputs,0));
+                break;
+            case DialKind::CompactSpline:
                 Cache::Manager::Get()
                     ->fCompactSplines
-                    ->AddSpline(resultIndex,parIndex,
+                    ->AddSpline(resultIndex,
+                                InputParameterIndex(*dialInputs,0),
                                 baseDial->getDialData());
-            }
-            const MonotonicSpline* monotonicSpline
-                = dynamic_cast<const MonotonicSpline*>(baseDial);
-            if (monotonicSpline) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                break;
+            case DialKind::MonotonicSpline:
                 Cache::Manager::Get()
                     ->fMonotonicSplines
-                    ->AddSpline(resultIndex,parIndex,
+                    ->AddSpline(resultIndex,
+                                InputParameterIndex(*dialInputs,0),
                                 baseDial->getDialData());
-            }
-            const UniformSpline* uniformSpline
-                = dynamic_cast<const UniformSpline*>(baseDial);
-            if (uniformSpline) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                break;
+            case DialKind::UniformSpline:
                 Cache::Manager::Get()
                     ->fUniformSplines
-                    ->AddSpline(resultIndex,parIndex,
+                    ->AddSpline(resultIndex,
+                                InputParameterIndex(*dialInputs,0),
                                 baseDial->getDialData());
-            }
-            const GeneralSpline* generalSpline
-                = dynamic_cast<const GeneralSpline*>(baseDial);
-            if (generalSpline) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                break;
+            case DialKind::GeneralSpline:
                 Cache::Manager::Get()
                     ->fGeneralSplines
-                    ->AddSpline(resultIndex,parIndex,
-                                baseDial->getDialData());
-            }
-            const LightGraph* lightGraph
-                = dynamic_cast<const LightGraph*>(baseDial);
-            if (lightGraph) {
-                ++dialUsed;
-                const Parameter* fp = &(dialInputs->getParameter(0));
-                int parIndex = Cache::Manager::ParameterMap[fp];
+                    ->AddSpline(resultIndex,
+                                InputParameterIndex(*dialInputs,0),
+                                static_cast<const GeneralSpline*>(baseDial)
+                                ->getFullSplineData());
+                break;
+            case DialKind::LightGraph:
                 Cache::Manager::Get()
                     ->fGraphs
-                    ->AddGraph(resultIndex,parIndex,
+                    ->AddGraph(resultIndex,
+                               InputParameterIndex(*dialInputs,0),
                                baseDial->getDialData());
+                break;
+            case DialKind::GridSpline: {
+                const GridSpline* gridSpline
+                    = static_cast<const GridSpline*>(baseDial);
+                std::vector<int> parIndices;
+                for (int i = 0; i < gridSpline->getNbDimensions(); ++i) {
+                    parIndices.push_back(InputParameterIndex(*dialInputs,i));
+                }
+                Cache::Manager::Get()
+                    ->fGridSplines
+                    ->AddGrid(resultIndex,parIndices,
+                              baseDial->getDialData());
+                break;
             }
-            const Shift* shift
-                = dynamic_cast<const Shift*>(baseDial);
-            if (shift) {
-                ++dialUsed;
-                initialEventWeight *= shift->evalResponse(DialInputBuffer());
+            case DialKind::Shift: {
+                // The shifts are folded into the initial weight, so the
+                // masks are applied here, and are checked before each fill.
+                bool masked = false;
+                for (int i = 0; i < dialInputs->getBufferSize(); ++i) {
+                    int parIndex = InputParameterIndex(*dialInputs,i);
+                    shiftParameters[parIndex] = true;
+                    if (ParameterSetList[parIndex]
+                        ->isMaskedForPropagation()) masked = true;
+                }
+                if (masked) break;
+                initialEventWeight *= static_cast<const Shift*>(baseDial)
+                    ->evalResponse(DialInputBuffer());
+                break;
             }
-
-            if (dialUsed != 1) {
-                LogError << "Problem with dial: " << dialUsed
+            default:
+                LogError << "Problem with dial: unsupported type"
                           << std::endl;
                 LogError << "Dial Type Name: "
                           << baseDial->getDialTypeName()
@@ -514,6 +690,24 @@ bool Cache::Manager::Update( SampleSet& sampleList,
 
     }
 
+    // Save the masks used for the shifts.
+    Cache::Manager::ShiftMasks.clear();
+    for (std::size_t i = 0; i < shiftParameters.size(); ++i) {
+        if (not shiftParameters[i]) continue;
+        Cache::Manager::ShiftMasks.emplace_back(
+            i, ParameterSetList[i]->isMaskedForPropagation());
+    }
+
+    // All of the dials are added, so the weight calculators can arrange
+    // their data.
+    Cache::Manager* manager = Cache::Manager::Get();
+    manager->GetWeightsCache().SetUsePartialProducts(fUsePartialProducts);
+    manager->GetWeightsCache().Prepare();
+    manager->fTotalBytes -= manager->fPartialProductBytes;
+    manager->fPartialProductBytes
+        = manager->GetWeightsCache().GetPartialProductMemory();
+    manager->fTotalBytes += manager->fPartialProductBytes;
+
     LogInfo << "Error checking for cache" << std::endl;
 
     // Error checking adding the dials to the cache!
@@ -591,20 +785,26 @@ bool Cache::Manager::Fill() {
         static bool printed = false;
         if (printed) break;
         printed = true;
-        for (auto& par : Cache::Manager::ParameterMap ) {
+        for (std::size_t i = 0;
+             i < Cache::Manager::ParameterList.size(); ++i) {
+            const Parameter* par = Cache::Manager::ParameterList[i];
             // This produces a crazy amount of output.
-            LogInfo  << "FILL: " << par.second
-                    << "/" << Cache::Manager::ParameterMap.size()
-                    << " " << par.first->isEnabled()
-                    << " " << par.first->getParameterValue()
-                    << " (" << par.first->getFullTitle() << ")"
+            LogInfo  << "FILL: " << i
+                    << "/" << Cache::Manager::ParameterList.size()
+                    << " " << par->isEnabled()
+                    << " " << par->getParameterValue()
+                    << " (" << par->getFullTitle() << ")"
                     << std::endl;
         }
     } while(false);
 #endif
-    for (auto& par : Cache::Manager::ParameterMap ) {
+    // The masks are applied by the weight calculators, so changing the
+    // masks doesn't need an update.
+    for (std::size_t i = 0; i < Cache::Manager::ParameterList.size(); ++i) {
         cache->GetParameterCache().SetParameter(
-            par.second, par.first->getParameterValue());
+            i, Cache::Manager::ParameterList[i]->getParameterValue());
+        cache->GetParameterCache().SetMasked(
+            i, Cache::Manager::ParameterSetList[i]->isMaskedForPropagation());
     }
     cache->GetWeightsCache().Apply();
     cache->GetHistogramsCache().Apply();
@@ -619,9 +819,26 @@ bool Cache::Manager::Fill() {
 }
 
 int Cache::Manager::ParameterIndex(const Parameter* fp) {
-    auto parMapIt = Cache::Manager::ParameterMap.find(fp);
-    if (parMapIt == Cache::Manager::ParameterMap.end()) return -1;
-    return parMapIt->second;
+    auto parIt = std::find(Cache::Manager::ParameterList.begin(),
+                           Cache::Manager::ParameterList.end(), fp);
+    if (parIt == Cache::Manager::ParameterList.end()) return -1;
+    return parIt - Cache::Manager::ParameterList.begin();
+}
+
+bool Cache::Manager::ShiftMasksChanged() {
+    for (const std::pair<int,bool>& shift : Cache::Manager::ShiftMasks) {
+        if (ParameterSetList[shift.first]->isMaskedForPropagation()
+            != shift.second) return true;
+    }
+    return false;
+}
+
+int Cache::Manager::InputParameterIndex(const DialInputBuffer& inputs,
+                                        int i) {
+    const DialInputBuffer::ParameterReference& ref
+        = inputs.getInputParameterIndicesList()[i];
+    return Cache::Manager::ParameterIndexTable[
+        Cache::Manager::ParameterSetOffset[ref.parSetIndex] + ref.parIndex];
 }
 
 // An MIT Style License
@@ -30,6 +30,7 @@ Cache::Parameters::Parameters(std::size_t parameters)
     fTotalBytes += GetParameterCount()*sizeof(double); // fParameters
     fTotalBytes += GetParameterCount()*sizeof(double);  // fLowerClamp
     fTotalBytes += GetParameterCount()*sizeof(double);  // fUpperclamp
+    fTotalBytes += GetParameterCount()*sizeof(short);   // fMasks
 
     try {
         // The mirrors are only on the CPU, so use vectors.  Initialize with
@@ -47,6 +48,7 @@ Cache::Parameters::Parameters(std::size_t parameters)
         fParameters.reset(new hemi::Array<double>(GetParameterCount()));
         fLowerClamp.reset(new hemi::Array<double>(GetParameterCount(),false));
         fUpperClamp.reset(new hemi::Array<double>(GetParameterCount(),false));
+        fMasks.reset(new hemi::Array<short>(GetParameterCount(),false));
     }
     catch (...) {
         LogError << "Failed to allocate memory, so stopping" << std::endl;
@@ -67,6 +69,9 @@ void Cache::Parameters::Reset() {
     std::fill(fUpperClamp->hostPtr(),
               fUpperClamp->hostPtr() + GetParameterCount(),
               std::numeric_limits<double>::max());
+    std::fill(fMasks->hostPtr(),
+              fMasks->hostPtr() + GetParameterCount(),
+              0);
 }
 
 double Cache::Parameters::GetParameter(int parIdx) const {
@@ -138,6 +143,21 @@ void Cache::Parameters::SetUpperClamp(int parIdx, double value) {
     fUpperClamp->hostPtr()[parIdx] = value;
 }
 
+bool Cache::Parameters::GetMasked(int parIdx) const {
+    if (parIdx < 0) throw;
+    if (GetParameterCount() <= parIdx) throw;
+    return fMasks->readOnlyHostPtr()[parIdx] != 0;
+}
+
+void Cache::Parameters::SetMasked(int parIdx, bool value) {
+    if (parIdx < 0) throw;
+    if (GetParameterCount() <= parIdx) throw;
+    // Only touch the host memory when the mask changes so that the masks
+    // are not copied to the device every iteration.
+    if (GetMasked(parIdx) == value) return;
+    fMasks->hostPtr()[parIdx] = value ? 1 : 0;
+}
+
 // An MIT Style License
 
 // Copyright (c) 2022 Clark McGrew
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <iostream>
 #include <exception>
+#include <new>
 #include <limits>
 #include <cmath>
 
@@ -52,6 +53,7 @@ Cache::Weights::Weights(std::size_t results)
 
 void Cache::Weights::Reset() {
     fResultsValid = false;
+    fPartialProductsValid = false;
     std::fill(fInitialValues->hostPtr(),
               fInitialValues->hostPtr() + fInitialValues->size(),
               1.0);
@@ -85,6 +87,7 @@ void Cache::Weights::SetResult(int i, double v) {
     if (i < 0) throw;
     if (GetResultCount() <= i) throw;
     fResults->hostPtr()[i] = v;
+    fPartialProductsValid = false;
 }
 
 double* Cache::Weights::GetResultPointer(int i) {
@@ -107,6 +110,7 @@ void Cache::Weights::SetInitialValue(int i, double v) {
     if (i < 0) throw;
     if (GetResultCount() <= i) throw;
     fInitialValues->hostPtr()[i] = v;
+    fPartialProductsValid = false;
 }
 
 // Define CACHE_DEBUG to get lots of output from the host
@@ -133,19 +137,150 @@ namespace {
 #endif
         }
     }
+
+    // A function to be used as the kernel on a CPU or GPU.  This must be
+    // valid CUDA.  This sets all of the results to the same value.
+    HEMI_KERNEL_FUNCTION(HEMIFillKernel,
+                         double* results,
+                         const double value,
+                         const int NP) {
+        for (int i : hemi::grid_stride_range(0,NP)) {
+            results[i] = value;
+        }
+    }
+
+    // The partial products passed by value to HEMIProductKernel.  This has
+    // one entry for each possible weight calculator.
+    struct PartialProducts {
+        int count;
+        const double* values[8];
+    };
+
+    // A function to be used as the kernel on a CPU or GPU.  This must be
+    // valid CUDA.  This sets the results to the initial values times the
+    // partial products.
+    HEMI_KERNEL_FUNCTION(HEMIProductKernel,
+                         double* results,
+                         const double* initialValues,
+                         const PartialProducts partials,
+                         const int NP) {
+        for (int i : hemi::grid_stride_range(0,NP)) {
+            double value = initialValues[i];
+            for (int j = 0; j < partials.count; ++j) {
+                value *= partials.values[j][i];
+            }
+            results[i] = value;
+        }
+    }
 }
 
-bool Cache::Weights::Apply() {
+void Cache::Weights::ReleasePartialProducts() {
+    for (int i=0; i<fWeightCalculators; ++i) {
+        if (!fWeightCalculator.at(i)) continue;
+        fWeightCalculator.at(i)->SetOutput(nullptr);
+    }
+    for (std::unique_ptr<Results>& partial : fPartialProducts) {
+        if (!partial) continue;
+        fTotalBytes -= partial->size()*sizeof(double);
+        partial.reset();
+    }
+    fPartialProductCount = 0;
+    fPartialProductsValid = false;
+}
 
-    HEMISetKernel setKernel;
-    hemi::launch(setKernel,
-                 fResults->writeOnlyPtr(),
-                 fInitialValues->readOnlyPtr(),
-                 GetResultCount());
+void Cache::Weights::Prepare() {
+    ReleasePartialProducts();
 
+    int used = 0;
     for (int i=0; i<fWeightCalculators; ++i) {
         if (!fWeightCalculator.at(i)) continue;
-        fWeightCalculator.at(i)->Apply();
+        fWeightCalculator.at(i)->Prepare();
+        fWeightCalculator.at(i)->SetDirty();
+        if (fWeightCalculator.at(i)->IsUsed()) ++used;
+    }
+
+    // With one calculator, every parameter change makes it dirty, so there
+    // is nothing to skip.
+    if (!fUsePartialProducts || used < 2) return;
+
+    try {
+        for (int i=0; i<fWeightCalculators; ++i) {
+            if (!fWeightCalculator.at(i)) continue;
+            if (!fWeightCalculator.at(i)->IsUsed()) continue;
+            fPartialProducts.at(i).reset(
+                new hemi::Array<double>(GetResultCount(),false));
+            fTotalBytes += GetResultCount()*sizeof(double);
+            // The hemi arrays are allocated when first used, and a failed
+            // device allocation is not reported, so allocate it now and
+            // check.
+            double* partial = fPartialProducts.at(i)->writeOnlyPtr();
+#ifdef __CUDACC__
+            if (cudaGetLastError() != cudaSuccess) partial = nullptr;
+#endif
+            if (!partial) throw std::bad_alloc();
+            fWeightCalculator.at(i)->SetOutput(fPartialProducts.at(i).get());
+            ++fPartialProductCount;
+        }
+    }
+    catch (std::bad_alloc&) {
+        LogWarning << "Not enough memory for the partial products, so"
+                   << " all of the weight calculators are always applied"
+                   << std::endl;
+        ReleasePartialProducts();
+        return;
+    }
+
+    LogInfo << "Cached Weights -- partial products for "
+            << fPartialProductCount << " calculators: "
+            << double(fPartialProductCount*GetResultCount()*sizeof(double))/1E+9
+            << " GB" << std::endl;
+}
+
+bool Cache::Weights::Apply() {
+
+    if (fPartialProductCount < 1) {
+        HEMISetKernel setKernel;
+        hemi::launch(setKernel,
+                     fResults->writeOnlyPtr(),
+                     fInitialValues->readOnlyPtr(),
+                     GetResultCount());
+
+        for (int i=0; i<fWeightCalculators; ++i) {
+            if (!fWeightCalculator.at(i)) continue;
+            fWeightCalculator.at(i)->Apply();
+        }
+    }
+    else {
+        // Only rerun the calculators with a changed input.  The others
+        // still have the right partial product.
+        bool changed = !fPartialProductsValid;
+        PartialProducts partials;
+        partials.count = 0;
+        for (int i=0; i<fWeightCalculators; ++i) {
+            if (!fPartialProducts.at(i)) continue;
+            Cache::Weight::Base* calculator = fWeightCalculator.at(i);
+            if (calculator->IsDirty()) {
+                HEMIFillKernel fillKernel;
+                hemi::launch(fillKernel,
+                             fPartialProducts.at(i)->writeOnlyPtr(),
+                             1.0,
+                             GetResultCount());
+                calculator->Apply();
+                calculator->SetApplied();
+                changed = true;
+            }
+            partials.values[partials.count++]
+                = fPartialProducts.at(i)->readOnlyPtr();
+        }
+        if (changed) {
+            HEMIProductKernel productKernel;
+            hemi::launch(productKernel,
+                         fResults->writeOnlyPtr(),
+                         fInitialValues->readOnlyPtr(),
+                         partials,
+                         GetResultCount());
+        }
+        fPartialProductsValid = true;
     }
 
     // Mark the results has having changed.
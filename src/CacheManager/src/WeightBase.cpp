@@ -1,3 +1,43 @@
 #include "WeightBase.h"
 
-void Cache::Weight::Base::Reset() {}
+void Cache::Weight::Base::Reset() {
+    fParameterUsed.clear();
+    fUsedParameters.clear();
+    fAppliedValues.clear();
+    fAppliedMasks.clear();
+    fApplied = false;
+}
+
+void Cache::Weight::Base::UseParameter(int parIndex) {
+    if (fParameterUsed.size() <= parIndex) {
+        fParameterUsed.resize(fParameters.size(), false);
+    }
+    fApplied = false;
+    if (fParameterUsed[parIndex]) return;
+    fParameterUsed[parIndex] = true;
+    fUsedParameters.push_back(parIndex);
+}
+
+bool Cache::Weight::Base::IsDirty() const {
+    if (!fApplied) return true;
+    // The values are set on the host, so this never copies from the device.
+    const double* values = fParameters.readOnlyHostPtr();
+    const short* masks = fMasks.readOnlyHostPtr();
+    for (std::size_t i = 0; i < fUsedParameters.size(); ++i) {
+        if (masks[fUsedParameters[i]] != fAppliedMasks[i]) return true;
+        if (values[fUsedParameters[i]] != fAppliedValues[i]) return true;
+    }
+    return false;
+}
+
+void Cache::Weight::Base::SetApplied() {
+    const double* values = fParameters.readOnlyHostPtr();
+    const short* masks = fMasks.readOnlyHostPtr();
+    fAppliedValues.resize(fUsedParameters.size());
+    fAppliedMasks.resize(fUsedParameters.size());
+    for (std::size_t i = 0; i < fUsedParameters.size(); ++i) {
+        fAppliedValues[i] = values[fUsedParameters[i]];
+        fAppliedMasks[i] = masks[fUsedParameters[i]];
+    }
+    fApplied = true;
+}
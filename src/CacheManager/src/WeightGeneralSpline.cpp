@@ -21,11 +21,12 @@ LoggerInit([]{
 Cache::Weight::GeneralSpline::GeneralSpline(
     Cache::Weights::Results& weights,
     Cache::Parameters::Values& parameters,
+    Cache::Parameters::Masks& masks,
     Cache::Parameters::Clamps& lowerClamps,
     Cache::Parameters::Clamps& upperClamps,
     std::size_t splines, std::size_t knots,
     std::string spaceOption)
-    : Cache::Weight::Base("generalSpline",weights,parameters),
+    : Cache::Weight::Base("generalSpline",weights,parameters,masks),
       fLowerClamp(lowerClamps), fUpperClamp(upperClamps),
       fSplinesReserved(splines), fSplinesUsed(0),
       fSplineSpaceReserved(knots), fSplineSpaceUsed(0) {
@@ -107,6 +108,7 @@ int Cache::Weight::GeneralSpline::FindPoints(const TSpline3* s) {
 
 void Cache::Weight::GeneralSpline::AddSpline(int resIndex, int parIndex,
                                              const std::vector<double>& splineData) {
+    fHostGroups.Invalidate();
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -132,13 +134,6 @@ void Cache::Weight::GeneralSpline::AddSpline(int resIndex, int parIndex,
                << std::endl;
         throw std::runtime_error("Invalid number of spline points");
     }
-    int knots = (splineData.size()-2)/3;
-    if (15 < knots) {
-        LogError << "Up to 15 knots supported by GeneralSpline " << knots
-                 << std::endl;
-        throw std::runtime_error("Invalid number of spline points");
-    }
-
     int newIndex = fSplinesUsed++;
     if (fSplinesUsed > fSplinesReserved) {
         LogError << "Not enough space reserved for splines"
@@ -147,6 +142,7 @@ void Cache::Weight::GeneralSpline::AddSpline(int resIndex, int parIndex,
     }
     fSplineResult->hostPtr()[newIndex] = resIndex;
     fSplineParameter->hostPtr()[newIndex] = parIndex;
+    UseParameter(parIndex);
     if (fSplineIndex->hostPtr()[newIndex] != fSplineSpaceUsed) {
         LogError << "Last spline knot index should be at old end of splines"
                   << std::endl;
@@ -329,6 +325,50 @@ double* Cache::Weight::GeneralSpline::GetCachePointer(int sIndex) {
 
 #include "CalculateGeneralSpline.h"
 #include "CacheAtomicMult.h"
+#include "WeightHostGroupsApply.h"
+
+namespace {
+    // Evaluate the general splines arranged by Cache::Weight::HostGroups (see
+    // WeightHostGroupsApply.h).  The knots are the lower bound, the inverse
+    // of the average step and the knot positions, and the rows are the value
+    // and slope of each knot.  This does the same calculation as CalculateGeneralSpline.
+    struct GeneralSplineHostEvaluator {
+        static constexpr int kTerms = 4;
+        static constexpr int kShared = 2;
+
+        static void Setup(const double x,
+                          const double* knots, const int knotCount,
+                          const int rows,
+                          int* row, double* shared) {
+            const int points = knotCount-2;
+            const int ix = CalculateKnotIndexWithGuess(x, knots[0], knots[1],
+                                                       knots+2, 1, points);
+            const double x1 = knots[2+ix];
+            const double x2 = knots[2+ix+1];
+            const double step = x2-x1;
+            for (int t = 0; t < 4; ++t) row[t] = 2*ix+t;
+            shared[0] = (x - x1)/step;
+            shared[1] = step;
+        }
+
+        static double Value(const double* p, const double* shared,
+                            const double lowerBound, double upperBound) {
+            const double fx = shared[0];
+            const double step = shared[1];
+            const double p1 = p[0];
+            const double m1 = p[1]*step;
+            const double p2 = p[2];
+            const double m2 = p[3]*step;
+            double v = ((((2.0*p1 - 2.0*p2 + m2 + m1)*fx
+                          + 3.0*p2 - 3.0*p1 - m2 - 2.0*m1)*fx
+                         +m1)*fx
+                        +p1);
+            if (v < lowerBound) v = lowerBound;
+            if (v > upperBound) v = upperBound;
+            return v;
+        }
+    };
+}
 
 namespace {
 
@@ -342,6 +382,7 @@ namespace {
                          double* splineValues,
 #endif
                          const double* params,
+                         const short* masks,
                          const double* lowerClamp,
                          const double* upperClamp,
                          const WEIGHT_BUFFER_FLOAT* knots,
@@ -362,12 +403,12 @@ namespace {
             const double lClamp = lowerClamp[pIndex[i]];
             const double uClamp = upperClamp[pIndex[i]];
 
-#ifndef HEMI_DEV_CODE
-            if (dim>15) std::runtime_error("To many bins in spline");
-#endif
-
-            double v = CalculateGeneralSpline(x, lClamp,uClamp,
-                                              &knots[id0],dim);
+            // A masked parameter has a neutral response.
+            double v = 1.0;
+            if (!masks[pIndex[i]]) {
+                v = CalculateGeneralSpline(x, lClamp,uClamp,
+                                           &knots[id0],dim);
+            }
 
 #ifdef CACHE_DEBUG
 #ifndef HEMI_DEV_CODE
@@ -410,19 +451,99 @@ void Cache::Weight::GeneralSpline::Reset() {
     // Reset this class
     fSplinesUsed = 0;
     fSplineSpaceUsed = 0;
+    fHostGroups.Clear();
+
+    // The spline arrays are shrunk once the host groups are built (see
+    // Prepare), so get them back to the reserved size.
+    if (fSplineResult && fSplineResult->size() < GetSplinesReserved()) {
+        try {
+            fSplineResult.reset(
+                new hemi::Array<int>(GetSplinesReserved(),false));
+            fSplineParameter.reset(
+                new hemi::Array<short>(GetSplinesReserved(),false));
+            fSplineIndex.reset(
+                new hemi::Array<int>(1+GetSplinesReserved(),false));
+            fSplineSpace.reset(
+                new hemi::Array<WEIGHT_BUFFER_FLOAT>(
+                    GetSplineSpaceReserved(),false));
+        }
+        catch (std::bad_alloc&) {
+            LogError << "Failed to allocate memory, so stopping" << std::endl;
+            throw std::runtime_error("Not enough memory available");
+        }
+        fSplineIndex->hostPtr()[0] = 0;
+    }
+}
+
+void Cache::Weight::GeneralSpline::Prepare() {
+    fHostGroups.Clear();
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    if (GetSplinesUsed() < 1) return;
+    const WEIGHT_BUFFER_FLOAT* space = fSplineSpace->hostPtr();
+    const int* index = fSplineIndex->hostPtr();
+    const int* result = fSplineResult->hostPtr();
+    const short* parameter = fSplineParameter->hostPtr();
+    std::vector<WEIGHT_BUFFER_FLOAT> knots;
+    std::vector<WEIGHT_BUFFER_FLOAT> values;
+    for (std::size_t i = 0; i < GetSplinesUsed(); ++i) {
+        const WEIGHT_BUFFER_FLOAT* data = space + index[i];
+        const int dim = index[i+1] - index[i];
+        // Split the knot positions from the values and slopes.
+        const int points = (dim-2)/3;
+        knots.assign(data, data+2);
+        values.clear();
+        for (int k = 0; k < points; ++k) {
+            values.push_back(data[2+3*k]);
+            values.push_back(data[2+3*k+1]);
+            knots.push_back(data[2+3*k+2]);
+        }
+        fHostGroups.Add(result[i], parameter[i],
+                        knots.data(), knots.size(),
+                        values.data(), values.size());
+    }
+    fHostGroups.Build();
+    LogInfo << "Host layout for " << GetName() << ": "
+            << fHostGroups.GetGroupCount() << " groups for "
+            << GetSplinesUsed() - fHostGroups.GetUngroupedCount()
+            << " splines ("
+            << fHostGroups.GetTotalBytes()/1E+6 << " MB), "
+            << fHostGroups.GetUngroupedCount() << " splines left"
+            << std::endl;
+
+    // The grouped splines are only kept in the host layout.
+    fSplineSpaceUsed = fHostGroups.KeepUngrouped(
+        fSplineResult, fSplineParameter, fSplineIndex, fSplineSpace);
+    fSplinesUsed = fHostGroups.GetUngroupedCount();
+#endif
 }
 
 bool Cache::Weight::GeneralSpline::Apply() {
-    if (GetSplinesUsed() < 1) return false;
+    if (GetSplinesUsed() < 1 && !fHostGroups.IsValid()) return false;
+
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    // Use the SIMD friendly layout when running on the CPU.  The splines
+    // that are not in a group are left for the generic kernel.
+    if (fHostGroups.IsValid()) {
+        ApplyHostGroups<GeneralSplineHostEvaluator>(
+            fHostGroups,
+            GetOutput().writeOnlyPtr(),
+            fParameters.readOnlyPtr(),
+            fMasks.readOnlyPtr(),
+            fLowerClamp.readOnlyPtr(),
+            fUpperClamp.readOnlyPtr());
+        if (GetSplinesUsed() < 1) return true;
+    }
+#endif
 
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
-                 fWeights.writeOnlyPtr(),
+                 GetOutput().writeOnlyPtr(),
 #ifdef CACHE_MANAGER_SLOW_VALIDATION
 #warning Using SLOW VALIDATION in Cache::Weight::GeneralSpline::Apply
                  fSplineValue->writeOnlyPtr(),
 #endif
                  fParameters.readOnlyPtr(),
+                 fMasks.readOnlyPtr(),
                  fLowerClamp.readOnlyPtr(),
                  fUpperClamp.readOnlyPtr(),
                  fSplineSpace->readOnlyPtr(),
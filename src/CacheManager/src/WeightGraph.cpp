@@ -21,10 +21,11 @@ LoggerInit([]{
 Cache::Weight::Graph::Graph(
     Cache::Weights::Results& weights,
     Cache::Parameters::Values& parameters,
+    Cache::Parameters::Masks& masks,
     Cache::Parameters::Clamps& lowerClamps,
     Cache::Parameters::Clamps& upperClamps,
     std::size_t graphs, std::size_t space)
-    : Cache::Weight::Base("graph",weights,parameters),
+    : Cache::Weight::Base("graph",weights,parameters,masks),
       fLowerClamp(lowerClamps), fUpperClamp(upperClamps),
       fGraphsReserved(graphs), fGraphsUsed(0),
       fGraphSpaceReserved(space), fGraphSpaceUsed(0) {
@@ -78,6 +79,7 @@ Cache::Weight::Graph::~Graph() {}
 
 void Cache::Weight::Graph::AddGraph(int resIndex, int parIndex,
                                              const std::vector<double>& graphData) {
+    fHostGroups.Invalidate();
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -103,13 +105,6 @@ void Cache::Weight::Graph::AddGraph(int resIndex, int parIndex,
                << std::endl;
         throw std::runtime_error("Invalid number of graph points");
     }
-    int knots = (graphData.size())/2;
-    if (15 < knots) {
-        LogError << "Up to 15 knots supported by Graph " << knots
-                 << std::endl;
-        throw std::runtime_error("Invalid number of graph points");
-    }
-
     int newIndex = fGraphsUsed++;
     if (fGraphsUsed > fGraphsReserved) {
         LogError << "Not enough space reserved for graphs"
@@ -118,6 +113,7 @@ void Cache::Weight::Graph::AddGraph(int resIndex, int parIndex,
     }
     fGraphResult->hostPtr()[newIndex] = resIndex;
     fGraphParameter->hostPtr()[newIndex] = parIndex;
+    UseParameter(parIndex);
     if (fGraphIndex->hostPtr()[newIndex] != fGraphSpaceUsed) {
         LogError << "Last graph knot index should be at old end of graphs"
                   << std::endl;
@@ -254,6 +250,53 @@ double Cache::Weight::Graph::GetGraphKnotPlace(int sIndex, int knot) {
 
 #include "CalculateGraph.h"
 #include "CacheAtomicMult.h"
+#include "WeightHostGroupsApply.h"
+
+namespace {
+    // Evaluate the graphs arranged by Cache::Weight::HostGroups (see
+    // WeightHostGroupsApply.h).  The knots are the inverse of the average
+    // point spacing (computed by Prepare) and the point positions, and the
+    // rows are the values at each point.  This does the same calculation as
+    // CalculateGraph.
+    struct GraphHostEvaluator {
+        static constexpr int kTerms = 2;
+        static constexpr int kShared = 2;
+
+        static void Setup(const double x,
+                          const double* knots, const int knotCount,
+                          const int rows,
+                          int* row, double* shared) {
+            const int points = knotCount-1;
+            // Short circuit 1 point graphs.
+            if (points < 2) {
+                row[0] = 0;
+                row[1] = 0;
+                shared[0] = 0.0;
+                shared[1] = 1.0;
+                return;
+            }
+            const int ix = CalculateKnotIndexWithGuess(x, knots[1], knots[0],
+                                                       knots+1, 1, points);
+            const double x1 = knots[1+ix];
+            const double x2 = knots[1+ix+1];
+            row[0] = ix;
+            row[1] = ix+1;
+            shared[0] = (x - x1)/(x2-x1);
+            shared[1] = 0.0;
+        }
+
+        static double Value(const double* p, const double* shared,
+                            const double lowerBound, double upperBound) {
+            if (shared[1] > 0.5) return p[0];
+            const double p1 = p[0];
+            const double m = p[1]-p1;
+            double v = p1 + shared[0]*m;
+            if (v < lowerBound) v = lowerBound;
+            if (v > upperBound) v = upperBound;
+            return v;
+        }
+    };
+}
 
 namespace {
 
@@ -262,6 +305,7 @@ namespace {
     HEMI_KERNEL_FUNCTION(HEMIGraphsKernel,
                          double* results,
                          const double* params,
+                         const short* masks,
                          const double* lowerClamp,
                          const double* upperClamp,
                          const WEIGHT_BUFFER_FLOAT* space,
@@ -277,11 +321,11 @@ namespace {
             const double lClamp = lowerClamp[pIndex[i]];
             const double uClamp = upperClamp[pIndex[i]];
 
-#ifndef HEMI_DEV_CODE
-            if (dim>15) std::runtime_error("To many bins in graph");
-#endif
-
-            double v = CalculateGraph(x, lClamp,uClamp,&space[id0],dim);
+            // A masked parameter has a neutral response.
+            double v = 1.0;
+            if (!masks[pIndex[i]]) {
+                v = CalculateGraph(x, lClamp,uClamp,&space[id0],dim);
+            }
 
             CacheAtomicMult(&results[rIndex[i]], v);
         }
@@ -294,15 +338,98 @@ void Cache::Weight::Graph::Reset() {
     // Reset this class
     fGraphsUsed = 0;
     fGraphSpaceUsed = 0;
+    fHostGroups.Clear();
+
+    // The graph arrays are shrunk once the host groups are built (see
+    // Prepare), so get them back to the reserved size.
+    if (fGraphResult && fGraphResult->size() < GetGraphsReserved()) {
+        try {
+            fGraphResult.reset(
+                new hemi::Array<int>(GetGraphsReserved(),false));
+            fGraphParameter.reset(
+                new hemi::Array<short>(GetGraphsReserved(),false));
+            fGraphIndex.reset(
+                new hemi::Array<int>(1+GetGraphsReserved(),false));
+            fGraphSpace.reset(
+                new hemi::Array<WEIGHT_BUFFER_FLOAT>(
+                    GetGraphSpaceReserved(),false));
+        }
+        catch (std::bad_alloc&) {
+            LogError << "Failed to allocate memory, so stopping" << std::endl;
+            throw std::runtime_error("Not enough memory available");
+        }
+        fGraphIndex->hostPtr()[0] = 0;
+    }
+}
+
+void Cache::Weight::Graph::Prepare() {
+    fHostGroups.Clear();
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    if (GetGraphsUsed() < 1) return;
+    const WEIGHT_BUFFER_FLOAT* space = fGraphSpace->hostPtr();
+    const int* index = fGraphIndex->hostPtr();
+    const int* result = fGraphResult->hostPtr();
+    const short* parameter = fGraphParameter->hostPtr();
+    std::vector<WEIGHT_BUFFER_FLOAT> knots;
+    std::vector<WEIGHT_BUFFER_FLOAT> values;
+    for (std::size_t i = 0; i < GetGraphsUsed(); ++i) {
+        const WEIGHT_BUFFER_FLOAT* data = space + index[i];
+        const int dim = index[i+1] - index[i];
+        // Split the point positions from the values.  The inverse of the
+        // average spacing goes first, so it's not computed for each
+        // evaluation.
+        const int points = dim/2;
+        knots.clear();
+        values.clear();
+        knots.push_back((points < 2) ? 0.0
+                        : (points-1)/(data[2*(points-1)+1]-data[1]));
+        for (int k = 0; k < points; ++k) {
+            values.push_back(data[2*k]);
+            knots.push_back(data[2*k+1]);
+        }
+        fHostGroups.Add(result[i], parameter[i],
+                        knots.data(), knots.size(),
+                        values.data(), values.size());
+    }
+    fHostGroups.Build();
+    LogInfo << "Host layout for " << GetName() << ": "
+            << fHostGroups.GetGroupCount() << " groups for "
+            << GetGraphsUsed() - fHostGroups.GetUngroupedCount()
+            << " graphs ("
+            << fHostGroups.GetTotalBytes()/1E+6 << " MB), "
+            << fHostGroups.GetUngroupedCount() << " graphs left"
+            << std::endl;
+
+    // The grouped graphs are only kept in the host layout.
+    fGraphSpaceUsed = fHostGroups.KeepUngrouped(
+        fGraphResult, fGraphParameter, fGraphIndex, fGraphSpace);
+    fGraphsUsed = fHostGroups.GetUngroupedCount();
+#endif
 }
 
 bool Cache::Weight::Graph::Apply() {
-    if (GetGraphsUsed() < 1) return false;
+    if (GetGraphsUsed() < 1 && !fHostGroups.IsValid()) return false;
+
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    // Use the SIMD friendly layout when running on the CPU.  The graphs
+    // that are not in a group are left for the generic kernel.
+    if (fHostGroups.IsValid()) {
+        ApplyHostGroups<GraphHostEvaluator>(
+            fHostGroups,
+            GetOutput().writeOnlyPtr(),
+            fParameters.readOnlyPtr(),
+            fMasks.readOnlyPtr(),
+            fLowerClamp.readOnlyPtr(),
+            fUpperClamp.readOnlyPtr());
+        if (GetGraphsUsed() < 1) return true;
+    }
+#endif
 
     HEMIGraphsKernel graphsKernel;
     hemi::launch(graphsKernel,
-                 fWeights.writeOnlyPtr(),
+                 GetOutput().writeOnlyPtr(),
                  fParameters.readOnlyPtr(),
+                 fMasks.readOnlyPtr(),
                  fLowerClamp.readOnlyPtr(),
                  fUpperClamp.readOnlyPtr(),
                  fGraphSpace->readOnlyPtr(),
@@ -0,0 +1,316 @@
+#include "CacheWeights.h"
+#include "WeightBase.h"
+#include "WeightGridSpline.h"
+
+#include <algorithm>
+#include <iostream>
+#include <exception>
+#include <limits>
+#include <cmath>
+
+#include <hemi/hemi_error.h>
+#include <hemi/launch.h>
+#include <hemi/grid_stride_range.h>
+
+#include "CalculateGridSpline.h"
+#include "CacheAtomicMult.h"
+
+#include "Logger.h"
+LoggerInit([]{
+  Logger::setUserHeaderStr("[Cache::Weight::GridSpline]");
+});
+
+// The constructor
+Cache::Weight::GridSpline::GridSpline(
+    Cache::Weights::Results& weights,
+    Cache::Parameters::Values& parameters,
+    Cache::Parameters::Masks& masks,
+    Cache::Parameters::Clamps& lowerClamps,
+    Cache::Parameters::Clamps& upperClamps,
+    std::size_t grids, std::size_t space)
+    : Cache::Weight::Base("gridSpline",weights,parameters,masks),
+      fLowerClamp(lowerClamps), fUpperClamp(upperClamps),
+      fGridsReserved(grids), fGridsUsed(0),
+      fGridSpaceReserved(space), fGridSpaceUsed(0) {
+
+    LogInfo << "Reserved " << GetName() << " Grids: "
+            << GetGridsReserved() << std::endl;
+    if (GetGridsReserved() < 1) return;
+
+    fTotalBytes += GetGridsReserved()*sizeof(int);      // fGridResult
+    fTotalBytes += GetGridsReserved()
+        *GRID_SPLINE_MAX_DIMENSION*sizeof(short);       // fGridParameter
+    fTotalBytes += (1+GetGridsReserved())*sizeof(int);  // fGridIndex
+
+    LogInfo << "Reserved " << GetName()
+            << " Grid Data: " << GetGridSpaceReserved()
+            << std::endl;
+
+    fTotalBytes += GetGridSpaceReserved()*sizeof(WEIGHT_BUFFER_FLOAT);
+
+    LogInfo << "Approximate Memory Size for " << GetName()
+            << ": " << fTotalBytes/1E+9
+            << " GB" << std::endl;
+
+    try {
+        // Get the CPU/GPU memory for the grid index tables.  These are
+        // copied once during initialization so do not pin the CPU memory into
+        // the page set.
+        fGridResult.reset(new hemi::Array<int>(GetGridsReserved(),false));
+        fGridParameter.reset(
+            new hemi::Array<short>(
+                GRID_SPLINE_MAX_DIMENSION*GetGridsReserved(),false));
+        fGridIndex.reset(new hemi::Array<int>(1+GetGridsReserved(),false));
+
+        // Get the CPU/GPU memory for the grid space.  This is copied once
+        // during initialization so do not pin the CPU memory into the page
+        // set.
+        fGridSpace.reset(
+            new hemi::Array<WEIGHT_BUFFER_FLOAT>(GetGridSpaceReserved(),false));
+    }
+    catch (std::bad_alloc&) {
+        LogError << "Failed to allocate memory, so stopping" << std::endl;
+        throw std::runtime_error("Not enough memory available");
+    }
+
+    // Initialize the caches.  Don't try to zero everything since the
+    // caches can be huge.
+    Reset();
+    fGridIndex->hostPtr()[0] = 0;
+}
+
+// The destructor
+Cache::Weight::GridSpline::~GridSpline() {}
+
+void Cache::Weight::GridSpline::AddGrid(int resIndex,
+                                        const std::vector<int>& parIndices,
+                                        const std::vector<double>& gridData) {
+    if (resIndex < 0) {
+        LogError << "Invalid result index"
+               << std::endl;
+        throw std::runtime_error("Negative result index");
+    }
+    if (fWeights.size() <= resIndex) {
+        LogError << "Invalid result index"
+               << std::endl;
+        throw std::runtime_error("Result index out of bounds");
+    }
+    if (gridData.size() < 4) {
+        LogError << "Insufficient data in grid " << gridData.size()
+               << std::endl;
+        throw std::runtime_error("Invalid grid data");
+    }
+    const int dims = int(gridData[0]);
+    if (dims < 1 || GRID_SPLINE_MAX_DIMENSION < dims
+        || parIndices.size() != std::size_t(dims)) {
+        LogError << "Invalid grid dimensions " << dims
+               << " with " << parIndices.size() << " parameters"
+               << std::endl;
+        throw std::runtime_error("Invalid grid dimensions");
+    }
+    for (int parIndex : parIndices) {
+        if (parIndex < 0) {
+            LogError << "Invalid parameter index"
+                   << std::endl;
+            throw std::runtime_error("Negative parameter index");
+        }
+        if (fParameters.size() <= parIndex) {
+            LogError << "Invalid parameter index " << parIndex
+                   << std::endl;
+            throw std::runtime_error("Parameter index out of bounds");
+        }
+    }
+    int newIndex = fGridsUsed++;
+    if (fGridsUsed > fGridsReserved) {
+        LogError << "Not enough space reserved for grids"
+                  << std::endl;
+        throw std::runtime_error("Not enough space reserved for grids");
+    }
+    fGridResult->hostPtr()[newIndex] = resIndex;
+    for (int d = 0; d < GRID_SPLINE_MAX_DIMENSION; ++d) {
+        fGridParameter->hostPtr()[GRID_SPLINE_MAX_DIMENSION*newIndex+d]
+            = parIndices[(d < dims) ? d : 0];
+    }
+    for (int parIndex : parIndices) UseParameter(parIndex);
+    if (fGridIndex->hostPtr()[newIndex] != fGridSpaceUsed) {
+        LogError << "Last grid data index should be at old end of grids"
+                  << std::endl;
+        throw std::runtime_error("Problem with control indices");
+    }
+    int dataIndex = fGridSpaceUsed;
+    fGridSpaceUsed += gridData.size();
+    if (fGridSpaceUsed > fGridSpaceReserved) {
+        LogError << "Not enough space reserved for grid space"
+               << std::endl;
+        throw std::runtime_error("Not enough space reserved for grid space");
+    }
+    fGridIndex->hostPtr()[newIndex+1] = fGridSpaceUsed;
+    for (std::size_t i = 0; i<gridData.size(); ++i) {
+        fGridSpace->hostPtr()[dataIndex+i] = gridData.at(i);
+    }
+
+}
+
+int Cache::Weight::GridSpline::GetGridDimensions(int sIndex) {
+    return int(GetGridData(sIndex,0));
+}
+
+int Cache::Weight::GridSpline::GetGridParameterIndex(int sIndex, int dim) {
+    if (sIndex < 0) {
+        throw std::runtime_error("Grid index invalid");
+    }
+    if (GetGridsUsed() <= sIndex) {
+        throw std::runtime_error("Grid index invalid");
+    }
+    if (dim < 0 || GetGridDimensions(sIndex) <= dim) {
+        throw std::runtime_error("Grid dimension invalid");
+    }
+    return fGridParameter->hostPtr()[GRID_SPLINE_MAX_DIMENSION*sIndex+dim];
+}
+
+double Cache::Weight::GridSpline::GetGridParameter(int sIndex, int dim) {
+    int i = GetGridParameterIndex(sIndex,dim);
+    if (i<0) {
+        throw std::runtime_error("Grid parameter index out of bounds");
+    }
+    if (fParameters.size() <= i) {
+        throw std::runtime_error("Grid parameter index out of bounds");
+    }
+    return fParameters.hostPtr()[i];
+}
+
+double Cache::Weight::GridSpline::GetGridLowerClamp(int sIndex) {
+    int i = GetGridParameterIndex(sIndex,0);
+    if (i<0) {
+        throw std::runtime_error("Grid lower clamp index out of bounds");
+    }
+    if (fLowerClamp.size() <= i) {
+        throw std::runtime_error("Grid lower clamp index out of bounds");
+    }
+    return fLowerClamp.hostPtr()[i];
+}
+
+double Cache::Weight::GridSpline::GetGridUpperClamp(int sIndex) {
+    int i = GetGridParameterIndex(sIndex,0);
+    if (i<0) {
+        throw std::runtime_error("Grid upper clamp index out of bounds");
+    }
+    if (fUpperClamp.size() <= i) {
+        throw std::runtime_error("Grid upper clamp index out of bounds");
+    }
+    return fUpperClamp.hostPtr()[i];
+}
+
+double Cache::Weight::GridSpline::GetGridData(int sIndex, int i) {
+    if (sIndex < 0) {
+        throw std::runtime_error("Grid index invalid");
+    }
+    if (GetGridsUsed() <= sIndex) {
+        throw std::runtime_error("Grid index invalid");
+    }
+    int spaceIndex = fGridIndex->hostPtr()[sIndex];
+    int count = fGridIndex->hostPtr()[sIndex+1] - spaceIndex;
+    if (i < 0) {
+        throw std::runtime_error("Grid data index invalid");
+    }
+    if (count <= i) {
+        throw std::runtime_error("Grid data index invalid");
+    }
+    return fGridSpace->hostPtr()[spaceIndex+i];
+}
+
+namespace {
+
+    // A function to be used as the kernel on either the CPU or GPU.  This
+    // must be valid CUDA coda.  The response clamps are the ones of the
+    // first parameter of the grid.
+    HEMI_KERNEL_FUNCTION(HEMIGridSplinesKernel,
+                         double* results,
+                         const double* params,
+                         const short* masks,
+                         const double* lowerClamp,
+                         const double* upperClamp,
+                         const WEIGHT_BUFFER_FLOAT* space,
+                         const int* rIndex,
+                         const short* pIndex,
+                         const int* sIndex,
+                         const int NP) {
+        for (int i : hemi::grid_stride_range(0,NP)) {
+            const int id0 = sIndex[i];
+            const int id1 = sIndex[i+1];
+            const int dim = id1-id0;
+            const short* p = &pIndex[GRID_SPLINE_MAX_DIMENSION*i];
+            // The grid has a neutral response if any of its parameters is
+            // masked.  The unused dimensions repeat the first parameter.
+            bool masked = false;
+            double x[GRID_SPLINE_MAX_DIMENSION];
+            for (int d = 0; d < GRID_SPLINE_MAX_DIMENSION; ++d) {
+                x[d] = params[p[d]];
+                if (masks[p[d]]) masked = true;
+            }
+            if (masked) continue;
+            const double lClamp = lowerClamp[p[0]];
+            const double uClamp = upperClamp[p[0]];
+
+            double v = CalculateGridSpline(x,lClamp,uClamp,&space[id0],dim);
+
+            CacheAtomicMult(&results[rIndex[i]], v);
+        }
+    }
+}
+
+void Cache::Weight::GridSpline::Reset() {
+    // Use the parent reset.
+    Cache::Weight::Base::Reset();
+    // Reset this class
+    fGridsUsed = 0;
+    fGridSpaceUsed = 0;
+}
+
+bool Cache::Weight::GridSpline::Apply() {
+    if (GetGridsUsed() < 1) return false;
+
+    HEMIGridSplinesKernel gridSplinesKernel;
+    hemi::launch(gridSplinesKernel,
+                 GetOutput().writeOnlyPtr(),
+                 fParameters.readOnlyPtr(),
+                 fMasks.readOnlyPtr(),
+                 fLowerClamp.readOnlyPtr(),
+                 fUpperClamp.readOnlyPtr(),
+                 fGridSpace->readOnlyPtr(),
+                 fGridResult->readOnlyPtr(),
+                 fGridParameter->readOnlyPtr(),
+                 fGridIndex->readOnlyPtr(),
+                 GetGridsUsed()
+        );
+
+    return true;
+}
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
@@ -0,0 +1 @@
+#include "WeightGridSpline.cpp"
@@ -0,0 +1,227 @@
+#include "WeightHostGroups.h"
+
+#include <algorithm>
+#include <numeric>
+
+void Cache::Weight::HostGroups::Clear() {
+    fEntries.clear();
+    fEntryKnots.clear();
+    fEntryValues.clear();
+    fUngrouped.clear();
+    fValid = false;
+    fGroups.clear();
+    fBatches.clear();
+    fKnots.clear();
+    fValues.clear();
+    fResults.clear();
+}
+
+void Cache::Weight::HostGroups::Add(int result, int parameter,
+                                    const WEIGHT_BUFFER_FLOAT* knots,
+                                    int knotCount,
+                                    const WEIGHT_BUFFER_FLOAT* values,
+                                    int rows) {
+    Entry entry;
+    entry.result = result;
+    entry.parameter = parameter;
+    entry.knotCount = knotCount;
+    entry.rows = rows;
+    entry.knots = fEntryKnots.size();
+    entry.values = fEntryValues.size();
+    fEntryKnots.insert(fEntryKnots.end(), knots, knots+knotCount);
+    fEntryValues.insert(fEntryValues.end(), values, values+rows);
+    fEntries.push_back(entry);
+    fValid = false;
+}
+
+void Cache::Weight::HostGroups::Build() {
+    fUngrouped.clear();
+    fGroups.clear();
+    fBatches.clear();
+    fKnots.clear();
+    fValues.clear();
+    fResults.clear();
+
+    // Order the splines by parameter, then by the shared knots.  The
+    // original order is kept inside a group, so the results of a batch are
+    // usually neighbours.
+    auto sameKnots = [this](const Entry& a, const Entry& b) {
+        return a.knotCount == b.knotCount
+            && std::equal(fEntryKnots.begin()+a.knots,
+                          fEntryKnots.begin()+a.knots+a.knotCount,
+                          fEntryKnots.begin()+b.knots);
+    };
+    auto lessKnots = [this](const Entry& a, const Entry& b) {
+        if (a.knotCount != b.knotCount) return a.knotCount < b.knotCount;
+        return std::lexicographical_compare(
+            fEntryKnots.begin()+a.knots,
+            fEntryKnots.begin()+a.knots+a.knotCount,
+            fEntryKnots.begin()+b.knots,
+            fEntryKnots.begin()+b.knots+b.knotCount);
+    };
+    std::vector<std::size_t> order(fEntries.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t ia, std::size_t ib) {
+                         const Entry& a = fEntries[ia];
+                         const Entry& b = fEntries[ib];
+                         if (a.parameter != b.parameter) {
+                             return a.parameter < b.parameter;
+                         }
+                         if (a.rows != b.rows) return a.rows < b.rows;
+                         return lessKnots(a,b);
+                     });
+
+    std::size_t begin = 0;
+    while (begin < order.size()) {
+        const Entry& first = fEntries[order[begin]];
+        std::size_t end = begin+1;
+        while (end < order.size()) {
+            const Entry& next = fEntries[order[end]];
+            if (next.parameter != first.parameter) break;
+            if (next.rows != first.rows) break;
+            if (!sameKnots(first,next)) break;
+            ++end;
+        }
+
+        // A small group would be mostly padding.
+        if (end-begin < kMinSplines) {
+            for (std::size_t i = begin; i < end; ++i) {
+                fUngrouped.push_back(order[i]);
+            }
+            begin = end;
+            continue;
+        }
+
+        Group group;
+        group.parameter = first.parameter;
+        group.knotCount = first.knotCount;
+        group.rows = first.rows;
+        const int splines = end-begin;
+        group.splines = splines;
+        group.stride = kBatch*((splines+kBatch-1)/kBatch);
+        group.knots = fKnots.size();
+        group.values = fValues.size();
+        group.results = fResults.size();
+
+        fKnots.insert(fKnots.end(),
+                      fEntryKnots.begin()+first.knots,
+                      fEntryKnots.begin()+first.knots+first.knotCount);
+
+        // The padding splines repeat the last spline, so the batches are
+        // full.  Their values are calculated, but not applied.
+        fValues.resize(fValues.size() + group.rows*group.stride);
+        fResults.resize(fResults.size() + group.stride);
+        for (int s = 0; s < group.stride; ++s) {
+            const Entry& entry
+                = fEntries[order[begin + std::min(s, splines-1)]];
+            fResults[group.results + s] = entry.result;
+            for (int r = 0; r < group.rows; ++r) {
+                fValues[group.values + r*group.stride + s]
+                    = fEntryValues[entry.values + r];
+            }
+        }
+
+        for (int s = 0; s < splines; s += kBatch) {
+            Batch batch;
+            batch.group = fGroups.size();
+            batch.first = s;
+            fBatches.push_back(batch);
+        }
+
+        fGroups.push_back(group);
+        begin = end;
+    }
+
+    std::sort(fUngrouped.begin(), fUngrouped.end());
+
+    // The added splines are not needed anymore.
+    std::vector<Entry>().swap(fEntries);
+    std::vector<double>().swap(fEntryKnots);
+    std::vector<WEIGHT_BUFFER_FLOAT>().swap(fEntryValues);
+
+    fValid = true;
+}
+
+std::size_t Cache::Weight::HostGroups::KeepUngrouped(
+    std::unique_ptr<hemi::Array<int>>& result,
+    std::unique_ptr<hemi::Array<short>>& parameter,
+    std::unique_ptr<hemi::Array<int>>& index,
+    std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>>& space) const {
+    const int* oldResult = result->readOnlyPtr(hemi::host);
+    const short* oldParameter = parameter->readOnlyPtr(hemi::host);
+    const int* oldIndex = index->readOnlyPtr(hemi::host);
+    const WEIGHT_BUFFER_FLOAT* oldSpace = space->readOnlyPtr(hemi::host);
+
+    std::size_t used = 0;
+    for (int s : fUngrouped) used += oldIndex[s+1] - oldIndex[s];
+
+    // Keep at least one element so the arrays are never empty.
+    const std::size_t splines = fUngrouped.size();
+    std::unique_ptr<hemi::Array<int>> newResult(
+        new hemi::Array<int>(std::max<std::size_t>(splines,1),false));
+    std::unique_ptr<hemi::Array<short>> newParameter(
+        new hemi::Array<short>(std::max<std::size_t>(splines,1),false));
+    std::unique_ptr<hemi::Array<int>> newIndex(
+        new hemi::Array<int>(splines+1,false));
+    std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> newSpace(
+        new hemi::Array<WEIGHT_BUFFER_FLOAT>(
+            std::max<std::size_t>(used,1),false));
+
+    int* keptResult = newResult->hostPtr();
+    short* keptParameter = newParameter->hostPtr();
+    int* keptIndex = newIndex->hostPtr();
+    WEIGHT_BUFFER_FLOAT* keptSpace = newSpace->hostPtr();
+    keptIndex[0] = 0;
+    for (std::size_t i = 0; i < splines; ++i) {
+        const int s = fUngrouped[i];
+        keptResult[i] = oldResult[s];
+        keptParameter[i] = oldParameter[s];
+        const int dim = oldIndex[s+1] - oldIndex[s];
+        std::copy(oldSpace + oldIndex[s], oldSpace + oldIndex[s] + dim,
+                  keptSpace + keptIndex[i]);
+        keptIndex[i+1] = keptIndex[i] + dim;
+    }
+
+    result = std::move(newResult);
+    parameter = std::move(newParameter);
+    index = std::move(newIndex);
+    space = std::move(newSpace);
+    return used;
+}
+
+std::size_t Cache::Weight::HostGroups::GetTotalBytes() const {
+    return fGroups.size()*sizeof(Group)
+        + fBatches.size()*sizeof(Batch)
+        + fKnots.size()*sizeof(double)
+        + fValues.size()*sizeof(WEIGHT_BUFFER_FLOAT)
+        + fResults.size()*sizeof(int);
+}
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
@@ -0,0 +1 @@
+#include "WeightHostGroups.cpp"
@@ -0,0 +1,144 @@
+#ifndef WeightHostGroupsApply_h_seen
+#define WeightHostGroupsApply_h_seen
+// The host kernel for the splines arranged by Cache::Weight::HostGroups.
+// This must be included after the hemi headers, and is only used when the
+// kernels run on the CPU.
+
+#include "WeightHostGroups.h"
+#include "CacheAtomicMult.h"
+
+// Compile the batch loop for several instruction sets, as the loops of
+// SplineBatch.cpp.  The dynamic loader picks the best one supported by the
+// CPU (GNU ifunc), so only ELF targets.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute) \
+    && !defined(HEMI_CUDA_COMPILER)
+#if __has_attribute(target_clones)
+#define HOST_GROUPS_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef HOST_GROUPS_TARGET_CLONES
+#define HOST_GROUPS_TARGET_CLONES
+#endif
+
+namespace {
+    /// Evaluate the kBatch splines of a batch into v.  The term pointers
+    /// are the rows of the kTerms values of the batch.  This is the loop
+    /// that vectorizes, so it is not inlined and is compiled for each
+    /// instruction set.
+    template <typename Evaluator>
+    HOST_GROUPS_TARGET_CLONES
+    void EvaluateHostBatch(const WEIGHT_BUFFER_FLOAT* const* term,
+                           const double* shared,
+                           const double lClamp,
+                           const double uClamp,
+                           double* v) {
+        constexpr int kBatch = Cache::Weight::HostGroups::kBatch;
+        constexpr int kTerms = Evaluator::kTerms;
+        for (int s = 0; s < kBatch; ++s) {
+            double p[kTerms];
+            for (int t = 0; t < kTerms; ++t) p[t] = term[t][s];
+            v[s] = Evaluator::Value(p, shared, lClamp, uClamp);
+        }
+    }
+
+    /// Apply the splines of a Cache::Weight::HostGroups to the results.  The
+    /// Evaluator describes the spline type with
+    ///
+    /// Evaluator::kTerms -- The number of values used for one spline.
+    ///
+    /// Evaluator::kShared -- The number of values shared by a batch.
+    ///
+    /// Evaluator::Setup(x, knots, knotCount, rows, row, shared) -- Fill the
+    ///     row of each of the kTerms values for the parameter value x, and
+    ///     the values shared by the batch (e.g. the position in the
+    ///     segment).  The rows are the number of values of each spline.
+    ///
+    /// Evaluator::Value(p, shared, lowerBound, upperBound) -- Calculate the
+    ///     value of a spline from its kTerms values.
+    ///
+    /// Value must not branch on the spline values (conditional expressions
+    /// are fine), so the loop over a batch is vectorized.
+    template <typename Evaluator>
+    void ApplyHostGroups(const Cache::Weight::HostGroups& hostGroups,
+                         double* results,
+                         const double* params,
+                         const short* masks,
+                         const double* lowerClamp,
+                         const double* upperClamp) {
+        constexpr int kBatch = Cache::Weight::HostGroups::kBatch;
+        constexpr int kTerms = Evaluator::kTerms;
+        const Cache::Weight::HostGroups::Group* groups
+            = hostGroups.GetGroups();
+        const Cache::Weight::HostGroups::Batch* batches
+            = hostGroups.GetBatches();
+        const double* knots = hostGroups.GetKnots();
+        const WEIGHT_BUFFER_FLOAT* values = hostGroups.GetValues();
+        const int* resultIndex = hostGroups.GetResults();
+        const int NB = hostGroups.GetBatchCount();
+
+        hemi::launch([=](int batchCount) {
+            for (int b : hemi::grid_stride_range(0,batchCount)) {
+                const Cache::Weight::HostGroups::Group& group
+                    = groups[batches[b].group];
+                // A masked parameter has a neutral response.
+                if (masks[group.parameter]) continue;
+                const int first = batches[b].first;
+                const double x = params[group.parameter];
+                const double lClamp = lowerClamp[group.parameter];
+                const double uClamp = upperClamp[group.parameter];
+
+                int row[kTerms];
+                double shared[Evaluator::kShared];
+                Evaluator::Setup(x, knots + group.knots, group.knotCount,
+                                 group.rows, row, shared);
+
+                const WEIGHT_BUFFER_FLOAT* term[kTerms];
+                for (int t = 0; t < kTerms; ++t) {
+                    term[t] = values + group.values
+                        + row[t]*group.stride + first;
+                }
+
+                // The padding makes every batch full, so the batch loop has
+                // a fixed length.
+                double v[kBatch];
+                EvaluateHostBatch<Evaluator>(term, shared, lClamp, uClamp, v);
+
+                const int* res = resultIndex + group.results + first;
+                int used = group.splines - first;
+                if (used > kBatch) used = kBatch;
+                for (int s = 0; s < used; ++s) {
+                    CacheAtomicMult(&results[res[s]], v[s]);
+                }
+            }
+        }, NB);
+    }
+}
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
@@ -21,11 +21,12 @@ LoggerInit([]{
 Cache::Weight::MonotonicSpline::MonotonicSpline(
     Cache::Weights::Results& weights,
     Cache::Parameters::Values& parameters,
+    Cache::Parameters::Masks& masks,
     Cache::Parameters::Clamps& lowerClamps,
     Cache::Parameters::Clamps& upperClamps,
     std::size_t splines, std::size_t knots,
     std::string spaceOption)
-    : Cache::Weight::Base("compactSpline",weights,parameters),
+    : Cache::Weight::Base("compactSpline",weights,parameters,masks),
       fLowerClamp(lowerClamps), fUpperClamp(upperClamps),
       fSplinesReserved(splines), fSplinesUsed(0),
       fSplineSpaceReserved(knots), fSplineSpaceUsed(0) {
@@ -106,6 +107,7 @@ int Cache::Weight::MonotonicSpline::FindPoints(const TSpline3* s) {
 void Cache::Weight::MonotonicSpline::AddSpline(int resIndex,
                                                int parIndex,
                                                const std::vector<double>& splineData) {
+    fHostGroups.Invalidate();
     if (resIndex < 0) {
         LogError << "Invalid result index"
                << std::endl;
@@ -142,6 +144,7 @@ void Cache::Weight::MonotonicSpline::AddSpline(int resIndex,
     }
     fSplineResult->hostPtr()[newIndex] = resIndex;
     fSplineParameter->hostPtr()[newIndex] = parIndex;
+    UseParameter(parIndex);
     if (fSplineIndex->hostPtr()[newIndex] != fSplineSpaceUsed) {
         LogError << "Last spline knot index should be at old end of splines"
                   << std::endl;
@@ -165,6 +168,7 @@ void Cache::Weight::MonotonicSpline::AddSpline(int resIndex,
 
 void Cache::Weight::MonotonicSpline::SetSplineKnot(
     int sIndex, int kIndex, double value) {
+    SetDirty();
     if (sIndex < 0) {
         LogError << "Requested spline index is negative"
                   << std::endl;
@@ -310,12 +314,80 @@ double* Cache::Weight::MonotonicSpline::GetCachePointer(int sIndex) {
 #endif
 
 #include "CacheAtomicMult.h"
+#include "WeightHostGroupsApply.h"
 #include "CalculateMonotonicSpline.h"
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
 #define PRINT_STEP 3
 
+namespace {
+    // Evaluate the monotonic splines arranged by Cache::Weight::HostGroups
+    // (see WeightHostGroupsApply.h).  The knots are the lower bound and the
+    // step, and the rows are the knot values.  This does the same
+    // calculation as CalculateMonotonicSpline.
+    struct MonotonicSplineHostEvaluator {
+        static constexpr int kTerms = 6;
+        static constexpr int kShared = 1;
+
+        static void Setup(const double x,
+                          const double* knots, const int knotCount,
+                          const int dim,
+                          int* row, double* shared) {
+            const double low = knots[0];
+            const double step = knots[1];
+
+            // Get the integer part
+            const double xx = (x-low)/step;
+            const int ix = (xx<0) ? xx-1: xx;
+
+            // The points to calculate d21, d32 and d43.
+            for (int d = 0; d < 3; ++d) {
+                int i0 = ix-1+d;
+                if (i0 < 0)     i0 = 0;
+                if (i0 > dim-2) i0 = dim-2;
+                row[2*d] = i0;
+                row[2*d+1] = i0+1;
+            }
+
+            shared[0] = xx-row[2];
+        }
+
+        static double Value(const double* p, const double* shared,
+                            const double lowerBound, double upperBound) {
+            const double fx = shared[0];
+            const double p2 = p[2];
+            const double p3 = p[3];
+            const double d21 = p[1] - p[0];
+            const double d32 = p3-p2;
+            const double d43 = p[5] - p[4];
+            double m2 = 0.5*(d21+d32);
+            double m3 = 0.5*(d32+d43);
+
+            // The Fritsh-Carlson condition.
+            if (d32*d21 <= 0.0) m2 = 0.0;
+            if (d43*d32 <= 0.0) m3 = 0.0;
+            const double ad21 = (d21<0) ? -d21: d21;
+            const double ad32 = (d32<0) ? -d32: d32;
+            const double ad43 = (d43<0) ? -d43: d43;
+            const double delta2 = 3.0*((ad21 < ad32) ? ad21 : ad32);
+            const double delta3 = 3.0*((ad32 < ad43) ? ad32 : ad43);
+            if (m2 > delta2) m2 = delta2;
+            if (m2 < -delta2) m2 = -delta2;
+            if (m3 > delta3) m3 = delta3;
+            if (m3 < -delta3) m3 = -delta3;
+
+            double v = ((((2.0*p2 - 2.0*p3 + m3 + m2)*fx
+                          + 3.0*p3 - 3.0*p2 - m3 - 2.0*m2)*fx
+                         +m2)*fx
+                        +p2);
+            if (v < lowerBound) v = lowerBound;
+            if (v > upperBound) v = upperBound;
+            return v;
+        }
+    };
+}
+
 namespace {
     // A function to be used as the kernel on either the CPU or GPU.  This
     // must be valid CUDA coda.
@@ -327,6 +399,7 @@ namespace {
                          double* splineValues,
 #endif
                          const double* params,
+                         const short* masks,
                          const double* lowerClamp,
                          const double* upperClamp,
                          const WEIGHT_BUFFER_FLOAT* knots,
@@ -342,8 +415,12 @@ namespace {
             const double lClamp = lowerClamp[pIndex[i]];
             const double uClamp = upperClamp[pIndex[i]];
 
-            double v = CalculateMonotonicSpline(x, lClamp,uClamp,
-                                                &knots[id0],dim);
+            // A masked parameter has a neutral response.
+            double v = 1.0;
+            if (!masks[pIndex[i]]) {
+                v = CalculateMonotonicSpline(x, lClamp,uClamp,
+                                             &knots[id0],dim);
+            }
 
 #ifdef CACHE_MANAGER_SLOW_VALIDATION
 #warning Using SLOW VALIDATION in Cache::Weight::MonotonicSpline::HEMISplinesKernel
@@ -372,19 +449,86 @@ void Cache::Weight::MonotonicSpline::Reset() {
     // Reset this class
     fSplinesUsed = 0;
     fSplineSpaceUsed = 0;
+    fHostGroups.Clear();
+
+    // The spline arrays are shrunk once the host groups are built (see
+    // Prepare), so get them back to the reserved size.
+    if (fSplineResult && fSplineResult->size() < GetSplinesReserved()) {
+        try {
+            fSplineResult.reset(
+                new hemi::Array<int>(GetSplinesReserved(),false));
+            fSplineParameter.reset(
+                new hemi::Array<short>(GetSplinesReserved(),false));
+            fSplineIndex.reset(
+                new hemi::Array<int>(1+GetSplinesReserved(),false));
+            fSplineSpace.reset(
+                new hemi::Array<WEIGHT_BUFFER_FLOAT>(
+                    GetSplineSpaceReserved(),false));
+        }
+        catch (std::bad_alloc&) {
+            LogError << "Failed to allocate memory, so stopping" << std::endl;
+            throw std::runtime_error("Not enough memory available");
+        }
+        fSplineIndex->hostPtr()[0] = 0;
+    }
+}
+
+void Cache::Weight::MonotonicSpline::Prepare() {
+    fHostGroups.Clear();
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    if (GetSplinesUsed() < 1) return;
+    const WEIGHT_BUFFER_FLOAT* space = fSplineSpace->hostPtr();
+    const int* index = fSplineIndex->hostPtr();
+    const int* result = fSplineResult->hostPtr();
+    const short* parameter = fSplineParameter->hostPtr();
+    for (std::size_t i = 0; i < GetSplinesUsed(); ++i) {
+        const WEIGHT_BUFFER_FLOAT* data = space + index[i];
+        const int dim = index[i+1] - index[i];
+        fHostGroups.Add(result[i], parameter[i], data, 2, data+2, dim-2);
+    }
+    fHostGroups.Build();
+    LogInfo << "Host layout for " << GetName() << ": "
+            << fHostGroups.GetGroupCount() << " groups for "
+            << GetSplinesUsed() - fHostGroups.GetUngroupedCount()
+            << " splines ("
+            << fHostGroups.GetTotalBytes()/1E+6 << " MB), "
+            << fHostGroups.GetUngroupedCount() << " splines left"
+            << std::endl;
+
+    // The grouped splines are only kept in the host layout.
+    fSplineSpaceUsed = fHostGroups.KeepUngrouped(
+        fSplineResult, fSplineParameter, fSplineIndex, fSplineSpace);
+    fSplinesUsed = fHostGroups.GetUngroupedCount();
+#endif
 }
 
 bool Cache::Weight::MonotonicSpline::Apply() {
-    if (GetSplinesUsed() < 1) return false;
+    if (GetSplinesUsed() < 1 && !fHostGroups.IsValid()) return false;
+
+#if !defined(HEMI_CUDA_COMPILER) && !defined(CACHE_MANAGER_SLOW_VALIDATION)
+    // Use the SIMD friendly layout when running on the CPU.  The splines
+    // that are not in a group are left for the generic kernel.
+    if (fHostGroups.IsValid()) {
+        ApplyHostGroups<MonotonicSplineHostEvaluator>(
+            fHostGroups,
+            GetOutput().writeOnlyPtr(),
+            fParameters.readOnlyPtr(),
+            fMasks.readOnlyPtr(),
+            fLowerClamp.readOnlyPtr(),
+            fUpperClamp.readOnlyPtr());
+        if (GetSplinesUsed() < 1) return true;
+    }
+#endif
 
     HEMISplinesKernel splinesKernel;
     hemi::launch(splinesKernel,
-                 fWeights.writeOnlyPtr(),
+                 GetOutput().writeOnlyPtr(),
 #ifdef CACHE_MANAGER_SLOW_VALIDATION
 #warning Using SLOW VALIDATION in Cache::Weight::MonotonicSpline::Apply
                  fSplineValue->writeOnlyPtr(),
 #endif
                  fParameters.readOnlyPtr(),
+                 fMasks.readOnlyPtr(),
                  fLowerClamp.readOnlyPtr(),
                  fUpperClamp.readOnlyPtr(),
                  fSplineSpace->readOnlyPtr(),
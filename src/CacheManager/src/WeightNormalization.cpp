@@ -19,8 +19,9 @@ LoggerInit([]{
 Cache::Weight::Normalization::Normalization(
     Cache::Weights::Results& weights,
     Cache::Parameters::Values& parameters,
+    Cache::Parameters::Masks& masks,
     std::size_t norms)
-    : Cache::Weight::Base("normalization",weights,parameters),
+    : Cache::Weight::Base("normalization",weights,parameters,masks),
       fNormsReserved(norms), fNormsUsed(0) {
 
     LogInfo << "Cached Weights: reserved Normalizations: "
@@ -84,6 +85,7 @@ int Cache::Weight::Normalization::ReserveNorm(int resIndex, int parIndex) {
     }
     fNormResult->hostPtr()[newIndex] = resIndex;
     fNormParameter->hostPtr()[newIndex] = parIndex;
+    UseParameter(parIndex);
     return newIndex;
 }
 
@@ -96,10 +98,13 @@ namespace {
     HEMI_KERNEL_FUNCTION(HEMINormsKernel,
                          double* results,
                          const double* params,
+                         const short* masks,
                          const int* rIndex,
                          const short* pIndex,
                          const int NP) {
         for (int i : hemi::grid_stride_range(0,NP)) {
+            // A masked parameter has a neutral response.
+            if (masks[pIndex[i]]) continue;
             CacheAtomicMult(&results[rIndex[i]], params[pIndex[i]]);
 #ifndef HEMI_DEV_CODE
 #ifdef CACHE_DEBUG
@@ -128,8 +133,9 @@ bool Cache::Weight::Normalization::Apply() {
 
     HEMINormsKernel normsKernel;
     hemi::launch(normsKernel,
-                 fWeights.writeOnlyPtr(),
+                 GetOutput().writeOnlyPtr(),
                  fParameters.readOnlyPtr(),
+                 fMasks.readOnlyPtr(),
                  fNormResult->readOnlyPtr(),
                  fNormParameter->readOnlyPtr(),
                  GetNormsUsed());
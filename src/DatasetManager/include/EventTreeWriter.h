@@ -22,7 +22,7 @@ public:
   void writeSamples(TDirectory* saveDir_, const Propagator& propagator_) const;
 
   void writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<Event> & eventList_) const;
-  void writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<const EventDialCache::CacheEntry*>& cacheSampleList_) const;
+  void writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<EventDialCache::CacheEntry>& cacheSampleList_) const;
 
 protected:
   void readConfigImpl() override;
@@ -31,10 +31,10 @@ protected:
   template<typename T> void writeEventsTemplate(TDirectory* saveDir_, const std::string& treeName_, const T& eventList_) const;
 
   static const Event* getEventPtr( const Event& ev_){ return &ev_; }
-  static const Event* getEventPtr( const EventDialCache::CacheEntry* ev_){ return ev_->event; }
+  static const Event* getEventPtr( const EventDialCache::CacheEntry& ev_){ return ev_.event; }
 
-  static const std::vector<EventDialCache::DialResponseCache>* getDialElementsPtr( const Event& ev_){ return nullptr; }
-  static const std::vector<EventDialCache::DialResponseCache>* getDialElementsPtr( const EventDialCache::CacheEntry* ev_){ return &ev_->dialResponseCacheList; }
+  static const EventDialCache::CacheEntry* getDialElementsPtr( const Event& ev_){ return nullptr; }
+  static const EventDialCache::CacheEntry* getDialElementsPtr( const EventDialCache::CacheEntry& ev_){ return &ev_; }
 
 private:
   // config
@@ -467,6 +467,9 @@ void DataDispenser::preAllocateMemory(){
 
           dialCollection->getDialBaseList().clear();
           dialCollection->getDialBaseList().resize(nEvents);
+          if( dialCollection->getDialArena() != nullptr ){
+            dialCollection->getDialArena()->setNbThreads(GundamGlobals::getParallelWorker().getNbThreads());
+          }
         }
         else{
           LogThrow("DEV ERROR: not binned, not event-by-event?");
@@ -1098,6 +1101,11 @@ void DataDispenser::fillFunction(int iThread_){
               );
             }
 
+            // The dial and its control block go to the slab of this thread
+            // in the dial arena (if the collection uses one).  The scope
+            // must outlive the unique_ptr below.
+            DialArena::Scope arenaScope{dialCollectionRef->getDialArena(), iThread_};
+
             // Do the unique_ptr dance so that memory gets deleted if
             // there is an exception (being stupidly paranoid).
             DialBaseFactory factory{};
@@ -1115,8 +1123,14 @@ void DataDispenser::fillFunction(int iThread_){
             if (dialBase != nullptr) {
               size_t freeSlotDial = dialCollectionRef->getNextDialFreeSlot();
               dialBase->setAllowExtrapolation(dialCollectionRef->isAllowDialExtrapolation());
-              dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
-                  dialBase.release());
+              if( dialCollectionRef->getDialArena() != nullptr ){
+                dialCollectionRef->getDialBaseList()[freeSlotDial] = dialCollectionRef->getDialArena()->makeDialObject(
+                    dialBase.release(), iThread_);
+              }
+              else{
+                dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
+                    dialBase.release());
+              }
 
               dialEntryPtr->collectionIndex = iCollection;
               dialEntryPtr->interfaceIndex = freeSlotDial;
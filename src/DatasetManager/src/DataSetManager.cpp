@@ -106,11 +106,11 @@ void DataSetManager::loadData(){
           LogDebug << "Toy events:" << std::endl;
           LogDebug << GET_VAR_NAME_VALUE(_propagator_.getDebugPrintLoadedEventsNbPerSample()) << std::endl;
           int iEvt{0};
-          for( auto& entry : _propagator_.getEventDialCache().getCache() ) {
+          for( size_t iEntry = 0 ; iEntry < _propagator_.getEventDialCache().getNbEvents() ; iEntry++ ) {
             LogDebug << "Event #" << iEvt++ << "{" << std::endl;
             {
               LogScopeIndent;
-              LogDebug << entry.getSummary() << std::endl;
+              LogDebug << _propagator_.getEventDialCache().getCacheEntry(iEntry).getSummary() << std::endl;
             }
             LogDebug << "}" << std::endl;
             if( iEvt >= _propagator_.getDebugPrintLoadedEventsNbPerSample() ) break;
@@ -195,7 +195,8 @@ void DataSetManager::loadData(){
   // reweighting cache.  This must also be before the first use of
   // reweightMcEvents.
   if( cacheManagerState ) {
-    Cache::Manager::Build(_propagator_.getSampleSet(), _propagator_.getEventDialCache());
+    Cache::Manager::Build(_propagator_.getSampleSet(), _propagator_.getEventDialCache(),
+                          _propagator_.getCacheManagerIndexWidth());
   }
 #endif
 
@@ -203,6 +204,10 @@ void DataSetManager::loadData(){
   _propagator_.reweightMcEvents();
 
   LogInfo << "Filling up sample bin caches..." << std::endl;
+  for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
+    sample.getMcContainer().updateEventListSortedByBin();
+    sample.getDataContainer().updateEventListSortedByBin();
+  }
   GundamGlobals::getParallelWorker().runJob([this](int iThread){
     LogInfoIf(iThread <= 0) << "Updating sample per bin event lists..." << std::endl;
     for( auto& sample : _propagator_.getSampleSet().getSampleList() ){
@@ -242,6 +247,9 @@ void DataSetManager::loadData(){
       // Asimov bin content -> toy data
       sample.getDataContainer().throwStatError( _propagator_.isGaussStatThrowInToys() );
     }
+
+    // the event weights have been modified outside the dial cache
+    _propagator_.getEventDialCache().requestFullReweight();
   }
 
   /// Now caching the event for the plot generator
@@ -57,11 +57,12 @@ void EventTreeWriter::writeSamples(TDirectory* saveDir_, const Propagator& propa
         this->writeEvents(GenericToolbox::mkdirTFile(saveDir_, sample.getName()), (isData ? "Data" : "MC"), *evListPtr);
       }
       else{
-        std::vector<const EventDialCache::CacheEntry*> cacheSampleList{};
-        cacheSampleList.reserve( propagator_.getEventDialCache().getCache().size() );
-        for( auto& cacheEntry : propagator_.getEventDialCache().getCache() ){
+        std::vector<EventDialCache::CacheEntry> cacheSampleList{};
+        cacheSampleList.reserve( propagator_.getEventDialCache().getNbEvents() );
+        for( size_t iEntry = 0 ; iEntry < propagator_.getEventDialCache().getNbEvents() ; iEntry++ ){
+          auto cacheEntry = propagator_.getEventDialCache().getCacheEntry( iEntry );
           if( cacheEntry.event->getIndices().sample == sample.getIndex() ){
-            cacheSampleList.emplace_back( &cacheEntry );
+            cacheSampleList.emplace_back( cacheEntry );
           }
         }
         cacheSampleList.shrink_to_fit();
@@ -76,7 +77,7 @@ void EventTreeWriter::writeEvents(TDirectory *saveDir_, const std::string& treeN
   LogReturnIf(not _isEnabled_, "Disabled EventTreeWriter. Skipping writeEvents.");
   this->writeEventsTemplate(saveDir_, treeName_, eventList_);
 }
-void EventTreeWriter::writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<const EventDialCache::CacheEntry*>& cacheSampleList_) const{
+void EventTreeWriter::writeEvents(TDirectory* saveDir_, const std::string& treeName_, const std::vector<EventDialCache::CacheEntry>& cacheSampleList_) const{
   LogReturnIf(not _isEnabled_, "Disabled EventTreeWriter. Skipping writeEvents.");
   this->writeEventsTemplate(saveDir_, treeName_, cacheSampleList_);
 }
@@ -87,7 +88,7 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
 
   LogReturnIf(eventList_.empty(), "No event to be written. Leaving...");
 
-  const std::vector<EventDialCache::DialResponseCache>* dialElements{getDialElementsPtr(eventList_[0])};
+  const EventDialCache::CacheEntry* dialElements{getDialElementsPtr(eventList_[0])};
   bool writeDials{dialElements != nullptr};
 
   LogInfo << "Writing " << eventList_.size() << " events " << (writeDials? "with response dials": "without response dials") << " in TTree " << treeName_ << std::endl;
@@ -227,11 +228,12 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
         grPtr->SetPointY(0, 1);
 
         // fetch corresponding dial if it exists
-        for( auto& dial : *dialElements ){
-          if( dial.dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parSetIndex == parIndexList[iGlobalPar].first
-              and dial.dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parIndex == parIndexList[iGlobalPar].second ){
+        for( size_t iDial = 0 ; iDial < dialElements->getNbDials() ; iDial++ ){
+          auto& dialInterface = dialElements->getDialInterface(iDial);
+          if( dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parSetIndex == parIndexList[iGlobalPar].first
+              and dialInterface.getInputBufferRef()->getInputParameterIndicesList()[0].parIndex == parIndexList[iGlobalPar].second ){
 
-            DialInputBuffer inputBuf{*dial.dialInterface.getInputBufferRef()};
+            DialInputBuffer inputBuf{*dialInterface.getInputBufferRef()};
             grPtr->RemovePoint(0); // remove the first and recreate the whole thing
             for( double xPoint : parameterXvalues[iGlobalPar] ){
               inputBuf.getInputBuffer()[0] = xPoint;
@@ -239,8 +241,8 @@ template<typename T> void EventTreeWriter::writeEventsTemplate(TDirectory* saveD
                   xPoint,
                   DialInterface::evalResponse(
                       &inputBuf,
-                      dial.dialInterface.getDialBaseRef(),
-                      dial.dialInterface.getResponseSupervisorRef()
+                      dialInterface.getDialBaseRef(),
+                      dialInterface.getResponseSupervisorRef()
                   )
               );
             }
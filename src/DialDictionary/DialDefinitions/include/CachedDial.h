@@ -6,24 +6,28 @@
 #define GUNDAM_CACHEDDIAL_H
 
 #include "DialInputBuffer.h"
+#include "EpochCachedValue.h"
+
 
 /// This is a template to add caching to a DialBase derived class.
+///
+/// The cached response is keyed on the epoch of the DialInputBuffer (see
+/// EpochCachedValue). Readers never block: a stale or busy cache simply means
+/// the response is evaluated again. The cache is not copied with the dial.
 template <typename T> class CachedDial: public T {
 public:
   CachedDial() = default;
+  CachedDial(const CachedDial& other_) = default;
+  CachedDial& operator=(const CachedDial& other_) = default;
+
+  [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<CachedDial>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(CachedDial); }
+
   double evalResponse(const DialInputBuffer& input_) const override;
   bool isCacheValid(const DialInputBuffer& input_) const;
-  void updateInputCache(const DialInputBuffer& input_) const;
 
 protected:
-  mutable double _cachedResponse_{std::nan("unset")}; // + 8 bytes
-  mutable GenericToolbox::NoCopyWrapper<std::mutex> _evalLock_{}; // + 64 bytes
-#if USE_ZLIB
-  // + 4 bytes (keeping a vector empty is already 24...)
-  mutable uint32_t _cachedInputHash_{0};
-#else
-  mutable std::vector<double> _cachedInputs_{}; // + 24 bytes
-#endif
+  EpochCachedValue _cachedResponse_{}; // + 16 bytes
 };
 
 
@@ -6,39 +6,26 @@
 #define GUNDAM_CACHEDDIAL_IMPL_H
 
 #include "CachedDial.h"
+#include "DialProfiler.h"
 
 template <typename T> double CachedDial<T>::evalResponse(const DialInputBuffer& input_) const {
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  #if HAS_CPP_17
-  std::scoped_lock<std::mutex> g(_evalLock_);
-  #else
-  std::lock_guard<std::mutex> g(_evalLock_);
-  #endif
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  _cachedResponse_ = this->T::evalResponse(input_);
-  updateInputCache(input_);
-  return _cachedResponse_;
+  const uint64_t epoch{input_.getEpoch()};
+
+  double response;
+  if( _cachedResponse_.fetch(epoch, response) ){
+    DialProfiler::countCacheHit();
+    return response;
+  }
+  DialProfiler::countCacheMiss();
+
+  response = this->T::evalResponse(input_);
+
+  // only one thread publishes; the others keep their own (identical) result
+  _cachedResponse_.publish(epoch, response);
+  return response;
 }
 template <typename T> bool CachedDial<T>::isCacheValid(const DialInputBuffer& input_) const {
-#if USE_ZLIB
-  return _cachedInputHash_ == input_.getCurrentHash();
-#else
-  if( _cachedInputs_.size() != input_.getBufferSize() ) return false;
-  return ( memcmp(
-             _cachedInputs_.data(), input_.getInputBuffer().data(),
-             input_.getBufferSize() * sizeof(*input_.getInputBuffer().data())) == 0 );
-#endif
-}
-template <typename T> void CachedDial<T>::updateInputCache(const DialInputBuffer& input_) const {
-#if USE_ZLIB
-  _cachedInputHash_ = input_.getCurrentHash();
-#else
-  if( _cachedInputs_.size() != input_.getBufferSize() ){
-    _cachedInputs_.resize(input_.getBufferSize(), std::nan("unset"));
-  }
-  memcpy(_cachedInputs_.data(), input_.getInputBuffer().data(),
-         input_.getBufferSize() * sizeof(*input_.getInputBuffer().data()));
-#endif
+  return _cachedResponse_.isValid(input_.getEpoch());
 }
 
 #endif //GUNDAM_CACHEDDIAL_IMPL_H
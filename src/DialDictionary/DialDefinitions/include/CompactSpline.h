@@ -20,6 +20,7 @@ public:
   ~CompactSpline() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<CompactSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(CompactSpline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"CompactSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -43,6 +44,9 @@ public:
                          const std::string& option_="") override;
 
   [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _splineData_.capacity()*sizeof(double); }
+  [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
+  [[nodiscard]] const std::pair<double, double>& getSplineBounds() const {return _splineBounds_;}
 
 protected:
   bool _allowExtrapolation_{false};
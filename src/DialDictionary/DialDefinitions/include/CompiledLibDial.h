@@ -13,6 +13,7 @@ public:
   CompiledLibDial() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<CompiledLibDial>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(CompiledLibDial); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"RootFormula"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -11,6 +11,8 @@
 #include <string>
 #include <memory>
 
+class TH1;
+
 // should be thread safe -> add lock?
 // any number of inputs (provided doubles) -> set input size
 // fast -> no checks while eval
@@ -26,11 +28,19 @@ public:
   DialBase() = default;
   virtual ~DialBase() = default;
 
+  // The dials created on a thread holding a DialArena::Scope are allocated
+  // in the arena of the collection being filled, the others on the heap.
+  static void* operator new(size_t size_);
+  static void operator delete(void* ptr_);
+
   // virtual layer + 8 bytes
 
   // Construct a copy of this dial.  Needed for PolymorphicObject.
   [[nodiscard]] virtual std::unique_ptr<DialBase> clone() const = 0;
 
+  // Size of the concrete dial object.
+  [[nodiscard]] virtual size_t getObjectSize() const = 0;
+
   // Return the name of the dial type (simple local RTTI).
   [[nodiscard]] virtual std::string getDialTypeName() const = 0;
 
@@ -70,6 +80,10 @@ public:
   /// Build the dial using a TSpline3 (usually a leaf in the input file).
   virtual void buildDial(const TSpline3& spl, const std::string& option_="") {throw std::runtime_error("Not implemented");}
 
+  /// Build the dial using a histogram (e.g. a TH2 or TH3 holding the
+  /// response of a multi-dimensional dial at its bin centers).
+  virtual void buildDial(const TH1& hist, const std::string& option_="") {throw std::runtime_error("Not implemented");}
+
   /// Build the dial using a double.  This is used on a "constant" dial like
   /// Shift, but can also be used in a dial that might do something like
   /// calculate the oscillation probability where the value could be closing
@@ -80,6 +94,16 @@ public:
   /// specific data contained in the vector depends on the derived class.
   [[nodiscard]] virtual const std::vector<double>& getDialData() const;
 
+  /// Return true if the other dial has the same concrete type and the same
+  /// content, so both give the same response for any input.  This is used to
+  /// share a single instance between identical dials.  Dials overriding it
+  /// must also implement getDialData().  The default is to never match.
+  [[nodiscard]] virtual bool isIdentical(const DialBase& other_) const { return false; }
+
+  /// Return the memory taken by the dial in bytes: the object itself and the
+  /// data it owns.  The default only counts the object.
+  [[nodiscard]] virtual size_t getMemoryFootprint() const { return getObjectSize(); }
+
 
 };
 
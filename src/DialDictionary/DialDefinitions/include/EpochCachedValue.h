@@ -0,0 +1,65 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_EPOCH_CACHED_VALUE_H
+#define GUNDAM_EPOCH_CACHED_VALUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cmath>
+
+
+/// A value cached for an epoch (see DialInputBuffer::getEpoch()), shared
+/// between threads without lock. This is a seqlock: a single thread
+/// publishes at a time, and the readers check the epoch again after reading
+/// the value. A reader never blocks, a stale or busy cache is a miss.
+///
+/// An interned dial is shared by input buffers with different epochs, so the
+/// value must never be seen with the epoch of another input. Used by
+/// CachedDial.
+class EpochCachedValue {
+
+public:
+  EpochCachedValue() = default;
+
+  /// The cached value is not copied
+  EpochCachedValue(const EpochCachedValue&) {}
+  EpochCachedValue& operator=(const EpochCachedValue&){ this->reset(); return *this; }
+
+  void reset(){ _epoch_.store(0, std::memory_order_relaxed); }
+
+  [[nodiscard]] bool isValid(uint64_t epoch_) const { return _epoch_.load(std::memory_order_acquire) == epoch_; }
+
+  /// Set value_ and return true if the value cached is the one of epoch_.
+  bool fetch(uint64_t epoch_, double& value_) const {
+    if( _epoch_.load(std::memory_order_acquire) != epoch_ ){ return false; }
+    value_ = _value_.load(std::memory_order_relaxed);
+    // make sure no writer started publishing in between
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return _epoch_.load(std::memory_order_relaxed) == epoch_;
+  }
+
+  /// Cache value_ for epoch_, unless another thread is already publishing.
+  void publish(uint64_t epoch_, double value_) const {
+    uint64_t cachedEpoch{_epoch_.load(std::memory_order_relaxed)};
+    if( cachedEpoch == _busyEpoch_ ){ return; }
+    if( not _epoch_.compare_exchange_strong(cachedEpoch, _busyEpoch_, std::memory_order_relaxed) ){ return; }
+    // the busy marker must be visible before the new value: a reader seeing
+    // the new value then fails its second epoch check
+    std::atomic_thread_fence(std::memory_order_release);
+    _value_.store(value_, std::memory_order_relaxed);
+    _epoch_.store(epoch_, std::memory_order_release);
+  }
+
+private:
+  /// Epoch reserved while a thread is publishing a new value
+  static constexpr uint64_t _busyEpoch_{~uint64_t(0)};
+
+  mutable std::atomic<double> _value_{std::nan("unset")}; // + 8 bytes
+  mutable std::atomic<uint64_t> _epoch_{0}; // + 8 bytes
+
+};
+
+
+#endif //GUNDAM_EPOCH_CACHED_VALUE_H
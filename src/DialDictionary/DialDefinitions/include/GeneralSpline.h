@@ -7,6 +7,7 @@
 
 #include "DialBase.h"
 #include "DialInputBuffer.h"
+#include "SplineKnotGrid.h"
 
 #include "TGraph.h"
 #include "TSpline.h"
@@ -21,6 +22,7 @@ public:
   GeneralSpline() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<GeneralSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(GeneralSpline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"GeneralSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -39,6 +41,23 @@ public:
                          const std::string& option_="") override;
 
    const std::vector<double>& getDialData() const override {return _splineData_;}
+   [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _splineData_.capacity()*sizeof(double); }
+   [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
+
+  /// Move the knot positions to a grid shared with other splines.  The
+  /// grid must have the same knots as the spline, and must outlive it.
+  /// Afterwards the dial data only holds the values and slopes at the knots.
+  void setKnotGrid(const SplineKnotGrid* knotGrid_);
+  [[nodiscard]] const SplineKnotGrid* getKnotGrid() const { return _knotGrid_; }
+
+  /// Return the spline data in the layout of CalculateGeneralSpline (with
+  /// the knot positions), even when the knots are on a shared grid.
+  [[nodiscard]] std::vector<double> getFullSplineData() const;
+  /// Size of getFullSplineData(), without building it.
+  [[nodiscard]] size_t getFullSplineDataSize() const {
+    if( _knotGrid_ == nullptr ){ return _splineData_.size(); }
+    return 2 + 3*size_t(_knotGrid_->getNbKnots());
+  }
 
 protected:
   bool _allowExtrapolation_{false};
@@ -48,6 +67,10 @@ protected:
   // functions that can be shared between the CPU and the GPU.
   std::vector<double> _splineData_{};
   std::pair<double, double> _splineBounds_{std::nan("unset"), std::nan("unset")};
+
+  // The shared knot positions (owned by the DialCollection).  When set, the
+  // spline data is {y0,s0,y1,s1,...} instead of {lowerBound,step,y0,s0,x0,...}.
+  const SplineKnotGrid* _knotGrid_{nullptr};
 };
 
 typedef CachedDial<GeneralSpline> GeneralSplineCache;
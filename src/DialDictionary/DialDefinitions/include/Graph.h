@@ -15,6 +15,7 @@ public:
   Graph() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Graph>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(Graph); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Graph"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -23,6 +24,8 @@ public:
 
   virtual void buildDial(const TGraph& grf, const std::string& option_="") override;
 
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + 2*size_t(_graph_.GetN())*sizeof(double); }
+
 protected:
   [[nodiscard]] double evaluateGraph(const DialInputBuffer& input_) const;
 
@@ -0,0 +1,68 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_GRIDSPLINE_H
+#define GUNDAM_GRIDSPLINE_H
+
+#include "DialBase.h"
+#include "DialInputBuffer.h"
+
+#include <vector>
+#include <string>
+
+
+/// A DialBase class interpolating a response depending on several inputs
+/// (up to GRID_SPLINE_MAX_DIMENSION), known on a rectilinear grid of knots.
+/// The interpolation is the tensor product of one dimensional linear
+/// (bilinear, trilinear) or Catmull-Rom cubic interpolations.  The knots of
+/// each dimension don't need to be evenly spaced.  The inputs of the dial
+/// are the parameters of the input buffer, in order.
+class GridSpline : public DialBase {
+
+public:
+  GridSpline() = default;
+  ~GridSpline() override = default;
+
+  [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<GridSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(GridSpline); }
+  [[nodiscard]] std::string getDialTypeName() const override { return {"GridSpline"}; }
+  [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
+
+  [[nodiscard]] std::string getSummary() const override;
+
+  void setAllowExtrapolation(bool allowExtrapolation) override;
+  [[nodiscard]] bool getAllowExtrapolation() const override;
+
+  /// Build the dial from a histogram with one to three dimensions.  The
+  /// knots are the bin centers, and the values the bin contents.  The
+  /// option is "cubic" for the cubic interpolation, otherwise the
+  /// interpolation is linear.
+  virtual void buildDial(const TH1& hist_, const std::string& option_="") override;
+
+  /// Build the dial from the knot positions of each dimension (increasing
+  /// order) and the values at the knots, with the first dimension running
+  /// fastest.
+  void buildGrid(const std::vector<std::vector<double>>& knotList_,
+                 const std::vector<double>& valueList_,
+                 const std::string& option_="");
+
+  [[nodiscard]] int getNbDimensions() const { return _gridData_.empty() ? 0 : int(_gridData_[0]); }
+  [[nodiscard]] bool isCubic() const { return not _gridData_.empty() and _gridData_[1] > 0.5; }
+
+  [[nodiscard]] const std::vector<double>& getDialData() const override {return _gridData_;}
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _gridData_.capacity()*sizeof(double); }
+  [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
+
+protected:
+  bool _allowExtrapolation_{false};
+
+  // The grid packed as described in CalculateGridSpline.  This must be
+  // filled for the Cache::Manager to work.
+  std::vector<double> _gridData_{};
+};
+
+typedef CachedDial<GridSpline> GridSplineCache;
+
+
+#endif //GUNDAM_GRIDSPLINE_H
@@ -21,6 +21,7 @@ public:
   LightGraph() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<LightGraph>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(LightGraph); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"LightGraph"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -30,6 +31,8 @@ public:
   virtual void buildDial(const TGraph& grf, const std::string& option_="") override;
 
   const std::vector<double>& getDialData() const override {return _Data_;}
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _Data_.capacity()*sizeof(double); }
+  [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
 
 protected:
   bool _allowExtrapolation_{false};
@@ -20,6 +20,7 @@ public:
   ~MonotonicSpline() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<MonotonicSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(MonotonicSpline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"MonotonicSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -38,6 +39,8 @@ public:
                          const std::string& option_="") override;
 
   [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _splineData_.capacity()*sizeof(double); }
+  [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
 
 protected:
   bool _allowExtrapolation_{false};
@@ -16,6 +16,7 @@ public:
   Norm() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Norm>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(Norm); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Norm"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override { return input_.getInputBuffer()[0]; }
 
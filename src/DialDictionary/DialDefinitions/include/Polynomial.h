@@ -16,10 +16,12 @@ public:
   Polynomial() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Polynomial>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(Polynomial); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Polynomial"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
   void setAllowExtrapolation(bool allowExtrapolation_) override { _allowExtrapolation_ = allowExtrapolation_; }
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _coefficientList_.capacity()*sizeof(double); }
 
   void setCoefficientList(const std::vector<double> &coefficientList_){ _coefficientList_ = coefficientList_; }
   void setSplineBounds(const std::pair<double, double>& splineBounds_){ _splineBounds_ = splineBounds_; }
@@ -18,6 +18,7 @@ public:
   RootFormula() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<RootFormula>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(RootFormula); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"RootFormula"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
   [[nodiscard]] std::string getSummary() const override;
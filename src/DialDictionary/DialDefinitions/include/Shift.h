@@ -16,6 +16,7 @@ public:
   Shift() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Shift>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(Shift); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Shift"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override { return _shiftValue_; }
 
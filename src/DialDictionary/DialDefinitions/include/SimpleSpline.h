@@ -21,6 +21,7 @@ public:
   ~SimpleSpline() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<SimpleSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(SimpleSpline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"SimpleSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -36,6 +37,8 @@ public:
   virtual void buildDial(const TSpline3& spl, const std::string& option_="") override;
 
   [[nodiscard]] const std::vector<double>& getDialData() const override {return _splineData_;}
+  [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _splineData_.capacity()*sizeof(double); }
+  [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
 
 protected:
   bool _isUniform_{false};
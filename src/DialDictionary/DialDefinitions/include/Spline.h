@@ -15,6 +15,7 @@ public:
   Spline() = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<Spline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(Spline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"Spline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
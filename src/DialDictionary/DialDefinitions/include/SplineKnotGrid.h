@@ -0,0 +1,46 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_SPLINE_KNOT_GRID_H
+#define GUNDAM_SPLINE_KNOT_GRID_H
+
+#include <vector>
+#include <cmath>
+
+
+/// Knot positions shared by the spline dials of a collection built on the
+/// same parameter grid. The dials referencing a grid only store the values
+/// and slopes at the knots. The spacing is cached so the knot segment of
+/// evenly spaced grids is found without searching.
+class SplineKnotGrid {
+
+public:
+  SplineKnotGrid() = default;
+  explicit SplineKnotGrid(const std::vector<double>& knotList_){ this->build(knotList_); }
+
+  /// Set the knot positions (in increasing order)
+  void build(const std::vector<double>& knotList_);
+
+  [[nodiscard]] bool isUniform() const { return _isUniform_; }
+  [[nodiscard]] int getNbKnots() const { return int(_knotList_.size()); }
+  [[nodiscard]] double getLowerBound() const { return _lowerBound_; }
+  [[nodiscard]] double getUpperBound() const { return _upperBound_; }
+  [[nodiscard]] double getStep() const { return _step_; }
+  [[nodiscard]] double getInvStep() const { return _invStep_; }
+  [[nodiscard]] const std::vector<double>& getKnotList() const { return _knotList_; }
+
+private:
+  /// true if the knots are evenly spaced (up to rounding)
+  bool _isUniform_{false};
+  double _lowerBound_{std::nan("unset")};
+  double _upperBound_{std::nan("unset")};
+  /// average step between the knots and its inverse
+  double _step_{std::nan("unset")};
+  double _invStep_{std::nan("unset")};
+  std::vector<double> _knotList_{};
+
+};
+
+
+#endif //GUNDAM_SPLINE_KNOT_GRID_H
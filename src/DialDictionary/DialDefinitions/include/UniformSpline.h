@@ -22,6 +22,7 @@ public:
   ~UniformSpline() override = default;
 
   [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<UniformSpline>(*this); }
+  [[nodiscard]] size_t getObjectSize() const override { return sizeof(UniformSpline); }
   [[nodiscard]] std::string getDialTypeName() const override { return {"UniformSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
@@ -40,6 +41,9 @@ public:
                          const std::string& option_="") override;
 
    const std::vector<double>& getDialData() const override {return _splineData_;}
+   [[nodiscard]] size_t getMemoryFootprint() const override { return DialBase::getMemoryFootprint() + _splineData_.capacity()*sizeof(double); }
+   [[nodiscard]] bool isIdentical(const DialBase& other_) const override;
+  [[nodiscard]] const std::pair<double, double>& getSplineBounds() const {return _splineBounds_;}
 
 protected:
   bool _allowExtrapolation_{false};
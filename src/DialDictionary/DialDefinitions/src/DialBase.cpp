@@ -3,6 +3,7 @@
 //
 
 #include "DialBase.h"
+#include "DialArena.h"
 
 #include "Logger.h"
 
@@ -10,6 +11,9 @@ LoggerInit([]{
   Logger::setUserHeaderStr("[DialBase]");
 });
 
+void* DialBase::operator new(size_t size_){ return DialArena::allocate(size_); }
+void DialBase::operator delete(void* ptr_){ DialArena::deallocate(ptr_); }
+
 const std::vector<double>& DialBase::getDialData() const {
     LogError << "getDialData not implemented for "
              << this->getDialTypeName()
@@ -8,6 +8,8 @@
 #include "GenericToolbox.Root.h"
 #include "Logger.h"
 
+#include <typeinfo>
+
 
 LoggerInit([]{
   Logger::setUserHeaderStr("[GeneralSpline]");
@@ -21,6 +23,49 @@ bool GeneralSpline::getAllowExtrapolation() const {
   return _allowExtrapolation_;
 }
 
+bool GeneralSpline::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const GeneralSpline&>(other_);
+  return _allowExtrapolation_ == other._allowExtrapolation_
+         and _splineBounds_ == other._splineBounds_
+         and _knotGrid_ == other._knotGrid_
+         and _splineData_ == other._splineData_;
+}
+
+void GeneralSpline::setKnotGrid(const SplineKnotGrid* knotGrid_){
+  LogThrowIf(knotGrid_ == nullptr, "Invalid knot grid.");
+  LogThrowIf(_knotGrid_ != nullptr, "Knot grid already set.");
+
+  const auto& knotList = knotGrid_->getKnotList();
+  LogThrowIf(_splineData_.size() != 2 + 3*knotList.size(),
+             "Knot grid doesn't match the spline: " << knotList.size() << " knots for " << _splineData_.size() << " data points.");
+
+  // sized exactly: the original buffer is released
+  std::vector<double> valueSlopeList(2*knotList.size());
+  for( size_t iKnot = 0 ; iKnot < knotList.size() ; iKnot++ ){
+    LogThrowIf(_splineData_[2 + 3*iKnot + 2] != knotList[iKnot], "Knot grid doesn't match the spline at knot #" << iKnot);
+    valueSlopeList[2*iKnot + 0] = _splineData_[2 + 3*iKnot + 0];
+    valueSlopeList[2*iKnot + 1] = _splineData_[2 + 3*iKnot + 1];
+  }
+  _splineData_ = std::move(valueSlopeList);
+  _knotGrid_ = knotGrid_;
+}
+
+std::vector<double> GeneralSpline::getFullSplineData() const {
+  if( _knotGrid_ == nullptr ){ return _splineData_; }
+
+  const auto& knotList = _knotGrid_->getKnotList();
+  std::vector<double> out(2 + 3*knotList.size());
+  out[0] = _knotGrid_->getLowerBound();
+  out[1] = _knotGrid_->getInvStep();
+  for( size_t iKnot = 0 ; iKnot < knotList.size() ; iKnot++ ){
+    out[2 + 3*iKnot + 0] = _splineData_[2*iKnot + 0];
+    out[2 + 3*iKnot + 1] = _splineData_[2*iKnot + 1];
+    out[2 + 3*iKnot + 2] = knotList[iKnot];
+  }
+  return out;
+}
+
 void GeneralSpline::buildDial(const TGraph& graph_, const std::string& option_){
   // Copy the spline data into local storage.
   TGraph grf(graph_);
@@ -57,7 +102,8 @@ void GeneralSpline::buildDial(const std::vector<double>& xPoints,
 
   _splineData_.resize(2 + xPoints.size()*3);
   _splineData_[0] = xPoints.front();
-  _splineData_[1] = (xPoints.back()-xPoints.front())/(xPoints.size()-1.0);
+  // inverse of the average step, used by CalculateGeneralSpline
+  _splineData_[1] = (xPoints.size()-1.0)/(xPoints.back()-xPoints.front());
 
   // Copy the spline data into local storage.
   for (int i = 0; i < xPoints.size(); ++i) {
@@ -79,5 +125,13 @@ double GeneralSpline::evalResponse(const DialInputBuffer& input_) const {
     else if(dialInput >= _splineBounds_.second){ dialInput = _splineBounds_.second; }
   }
 
+  if( _knotGrid_ != nullptr ){
+    return CalculateGeneralSplineOnGrid(
+        dialInput, -1E20, 1E20, _splineData_.data(),
+        _knotGrid_->getKnotList().data(), _knotGrid_->getNbKnots(),
+        _knotGrid_->getStep(), _knotGrid_->getInvStep(), _knotGrid_->isUniform()
+    );
+  }
+
   return CalculateGeneralSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()) );
 }
@@ -0,0 +1,109 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "GridSpline.h"
+#include "CalculateGridSpline.h"
+
+#include "Logger.h"
+
+#include "TH1.h"
+
+#include <typeinfo>
+#include <sstream>
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[GridSpline]");
+});
+
+void GridSpline::setAllowExtrapolation(bool allowExtrapolation) {
+  _allowExtrapolation_ = allowExtrapolation;
+  if( not _gridData_.empty() ){ _gridData_[2] = _allowExtrapolation_ ? 1 : 0; }
+}
+
+bool GridSpline::getAllowExtrapolation() const {
+  return _allowExtrapolation_;
+}
+
+bool GridSpline::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const GridSpline&>(other_);
+  return _allowExtrapolation_ == other._allowExtrapolation_
+         and _gridData_ == other._gridData_;
+}
+
+void GridSpline::buildDial(const TH1& hist_, const std::string& option_) {
+  const int nDim{hist_.GetDimension()};
+  const TAxis* axisList[3]{hist_.GetXaxis(), hist_.GetYaxis(), hist_.GetZaxis()};
+
+  std::vector<std::vector<double>> knotList(nDim);
+  for( int iDim = 0 ; iDim < nDim ; iDim++ ){
+    for( int iBin = 1 ; iBin <= axisList[iDim]->GetNbins() ; iBin++ ){
+      knotList[iDim].emplace_back( axisList[iDim]->GetBinCenter(iBin) );
+    }
+  }
+
+  // GetBin() runs the x axis fastest, as the grid does
+  std::vector<double> valueList;
+  const int nx{hist_.GetNbinsX()};
+  const int ny{nDim > 1 ? hist_.GetNbinsY() : 1};
+  const int nz{nDim > 2 ? hist_.GetNbinsZ() : 1};
+  valueList.reserve(size_t(nx)*ny*nz);
+  for( int iz = 1 ; iz <= nz ; iz++ ){
+    for( int iy = 1 ; iy <= ny ; iy++ ){
+      for( int ix = 1 ; ix <= nx ; ix++ ){
+        valueList.emplace_back( hist_.GetBinContent(hist_.GetBin(ix, iy, iz)) );
+      }
+    }
+  }
+
+  buildGrid(knotList, valueList, option_);
+}
+
+void GridSpline::buildGrid(const std::vector<std::vector<double>>& knotList_,
+                           const std::vector<double>& valueList_,
+                           const std::string& option_) {
+  LogThrowIf(not _gridData_.empty(), "Grid data already set.");
+  LogThrowIf(knotList_.empty(), "No dimension for the grid.");
+  LogThrowIf(knotList_.size() > GRID_SPLINE_MAX_DIMENSION,
+             "Grids are limited to " << GRID_SPLINE_MAX_DIMENSION << " dimensions, got " << knotList_.size());
+
+  size_t nValues{1};
+  for( auto& knots : knotList_ ){
+    LogThrowIf(knots.empty(), "Empty grid dimension.");
+    for( size_t iKnot = 1 ; iKnot < knots.size() ; iKnot++ ){
+      LogThrowIf(not (knots[iKnot-1] < knots[iKnot]), "Grid knots must be in increasing order.");
+    }
+    nValues *= knots.size();
+  }
+  LogThrowIf(valueList_.size() != nValues,
+             "Grid has " << nValues << " knots, but " << valueList_.size() << " values were provided.");
+
+  _gridData_.reserve(3 + knotList_.size() + nValues);
+  _gridData_.emplace_back( double(knotList_.size()) );
+  _gridData_.emplace_back( option_.find("cubic") != std::string::npos ? 1 : 0 );
+  _gridData_.emplace_back( _allowExtrapolation_ ? 1 : 0 );
+  for( auto& knots : knotList_ ){ _gridData_.emplace_back( double(knots.size()) ); }
+  for( auto& knots : knotList_ ){ _gridData_.insert(_gridData_.end(), knots.begin(), knots.end()); }
+  _gridData_.insert(_gridData_.end(), valueList_.begin(), valueList_.end());
+}
+
+double GridSpline::evalResponse(const DialInputBuffer& input_) const {
+#ifndef NDEBUG
+  LogThrowIf(input_.getBufferSize() < getNbDimensions(),
+             "GridSpline with " << getNbDimensions() << " dimensions has only " << input_.getBufferSize() << " inputs.");
+#endif
+
+  return CalculateGridSpline(input_.getInputBuffer().data(), -1E20, 1E20,
+                             _gridData_.data(), int(_gridData_.size()));
+}
+
+std::string GridSpline::getSummary() const {
+  std::stringstream ss;
+  ss << getDialTypeName() << ": " << (isCubic() ? "cubic" : "linear") << " grid of ";
+  for( int iDim = 0 ; iDim < getNbDimensions() ; iDim++ ){
+    ss << (iDim == 0 ? "" : "x") << int(_gridData_[3+iDim]);
+  }
+  ss << " knots";
+  return ss.str();
+}
@@ -6,6 +6,8 @@
 
 #include "CalculateGraph.h"
 
+#include <typeinfo>
+
 LoggerInit([]{
   Logger::setUserHeaderStr("[LightGraph]");
 });
@@ -18,13 +20,19 @@ bool LightGraph::getAllowExtrapolation() const {
   return _allowExtrapolation_;
 }
 
+bool LightGraph::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const LightGraph&>(other_);
+  return _allowExtrapolation_ == other._allowExtrapolation_
+         and _Data_ == other._Data_;
+}
+
 void LightGraph::buildDial(const TGraph &grf, const std::string& option_) {
   LogThrowIf(grf.GetN() == 0, "Invalid input graph");
   TGraph graph(grf);
   graph.Sort();
 
   int nPoints = graph.GetN();
-  LogThrowIf(nPoints>15, "Light graphs must have fewer than 15 points");
 
   _Data_.reserve(2*nPoints);
   _Data_.clear();
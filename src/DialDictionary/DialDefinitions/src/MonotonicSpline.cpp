@@ -8,6 +8,8 @@
 #include "GenericToolbox.Root.h"
 #include "Logger.h"
 
+#include <typeinfo>
+
 LoggerInit([]{
   Logger::setUserHeaderStr("[MonotonicSpline]");
 });
@@ -20,6 +22,14 @@ bool MonotonicSpline::getAllowExtrapolation() const {
   return _allowExtrapolation_;
 }
 
+bool MonotonicSpline::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const MonotonicSpline&>(other_);
+  return _allowExtrapolation_ == other._allowExtrapolation_
+         and _splineBounds_ == other._splineBounds_
+         and _splineData_ == other._splineData_;
+}
+
 void MonotonicSpline::buildDial(const TSpline3& spline, const std::string& option_) {
   std::vector<double> xPoint(spline.GetNp());
   std::vector<double> yPoint(spline.GetNp());
@@ -11,6 +11,8 @@
 #include "Logger.h"
 #include "GenericToolbox.Root.h"
 
+#include <typeinfo>
+
 LoggerInit([]{
   Logger::setUserHeaderStr("[SimpleSpline]");
 });
@@ -23,6 +25,15 @@ bool SimpleSpline::getAllowExtrapolation() const {
   return _allowExtrapolation_;
 }
 
+bool SimpleSpline::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const SimpleSpline&>(other_);
+  return _isUniform_ == other._isUniform_
+         and _allowExtrapolation_ == other._allowExtrapolation_
+         and _splineBounds_ == other._splineBounds_
+         and _splineData_ == other._splineData_;
+}
+
 void SimpleSpline::buildDial(const TGraph& grf, const std::string& option_){
   LogThrowIf(not _splineData_.empty(), "Spline data already set.");
   TGraph graph_ = grf;
@@ -74,7 +85,8 @@ void SimpleSpline::buildDial(const TGraph& grf, const std::string& option_){
 
     _splineData_.resize(2 + sp.GetNp() * 3);
     _splineData_[0] = sp.GetXmin();
-    _splineData_[1] = ((sp.GetXmax() - sp.GetXmin() ) / (sp.GetNp() - 1.0 ) );
+    // inverse of the average step, used by CalculateGeneralSpline
+    _splineData_[1] = ((sp.GetNp() - 1.0 ) / (sp.GetXmax() - sp.GetXmin() ) );
 
     // Copy the spline data into local storage.
     for (int i = 0; i < sp.GetNp(); ++i) {
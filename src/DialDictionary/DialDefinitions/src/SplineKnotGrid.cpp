@@ -0,0 +1,34 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "SplineKnotGrid.h"
+
+#include "Logger.h"
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[SplineKnotGrid]");
+});
+
+
+void SplineKnotGrid::build(const std::vector<double>& knotList_){
+  LogThrowIf(knotList_.size() < 2, "A knot grid needs at least two knots.");
+
+  _knotList_ = knotList_;
+  _knotList_.shrink_to_fit();
+  _lowerBound_ = _knotList_.front();
+  _upperBound_ = _knotList_.back();
+  _step_ = (_upperBound_ - _lowerBound_)/(double(_knotList_.size()) - 1.0);
+  LogThrowIf(not (_step_ > 0), "Invalid knot grid: [" << _lowerBound_ << ", " << _upperBound_ << "]");
+  _invStep_ = 1./_step_;
+
+  // the position in the segment is derived from the step on uniform grids:
+  // only accept spacings exact up to the rounding
+  _isUniform_ = true;
+  for( size_t iKnot = 0 ; iKnot < _knotList_.size() ; iKnot++ ){
+    if( iKnot+1 < _knotList_.size() ){
+      LogThrowIf(_knotList_[iKnot+1] <= _knotList_[iKnot], "Knots are not in increasing order.");
+    }
+    if( std::abs(_knotList_[iKnot] - (_lowerBound_ + double(iKnot)*_step_)) > 1E-12*_step_ ){ _isUniform_ = false; }
+  }
+}
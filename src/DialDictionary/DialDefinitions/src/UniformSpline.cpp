@@ -9,6 +9,7 @@
 #include "Logger.h"
 
 #include <limits>
+#include <typeinfo>
 
 LoggerInit([]{
   Logger::setUserHeaderStr("[UniformSpline]");
@@ -22,6 +23,14 @@ bool UniformSpline::getAllowExtrapolation() const {
   return _allowExtrapolation_;
 }
 
+bool UniformSpline::isIdentical(const DialBase& other_) const {
+  if( typeid(other_) != typeid(*this) ){ return false; }
+  auto& other = static_cast<const UniformSpline&>(other_);
+  return _allowExtrapolation_ == other._allowExtrapolation_
+         and _splineBounds_ == other._splineBounds_
+         and _splineData_ == other._splineData_;
+}
+
 void UniformSpline::buildDial(const TGraph& graph_, const std::string& option_){
   // Copy the spline data into local storage.
   TGraph grf(graph_);
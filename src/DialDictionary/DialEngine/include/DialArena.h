@@ -0,0 +1,98 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_DIAL_ARENA_H
+#define GUNDAM_DIAL_ARENA_H
+
+#include "DialBase.h"
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <cstddef>
+
+
+/// DialArena is a bump allocator holding the dial objects of a collection
+/// and the control blocks of their shared_ptr. Every thread filling the
+/// collection gets its own slab of memory blocks, so the loading threads
+/// don't contend on malloc. The memory is only released when the arena is
+/// destroyed, i.e. with the collection.
+///
+/// The allocations are routed through DialBase::operator new: a dial created
+/// on a thread holding a DialArena::Scope lives in the slab of that thread,
+/// any other dial is on the heap. No header is stored with the allocations:
+/// the memory of a dial is recognized by the slab of the scope, so an arena
+/// dial must either be released within the scope that created it, or be
+/// owned through makeDialObject(). The dials discarded later on (interned
+/// duplicates, tabulated dials) keep their memory until the arena goes away.
+///
+/// Only the dial objects are in the arena: the data vectors they own (knots,
+/// points, ...) are regular heap allocations. Dials must not be over-aligned.
+class DialArena {
+
+public:
+  explicit DialArena(size_t blockSize_ = 4*1024*1024): _blockSize_(blockSize_) {}
+
+  /// Route the dial allocations of the current thread to the slab iThread_
+  /// of the arena until the scope ends. A null arena selects the heap.
+  class Scope{
+  public:
+    Scope(DialArena* arena_, int iThread_);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  private:
+    void* _previousSlab_{nullptr};
+  };
+
+  /// Must be called before filling the arena, outside the threads.
+  void setNbThreads(int nbThreads_);
+
+  static void* allocate(size_t size_);
+  static void deallocate(void* ptr_);
+
+  /// Take the ownership of a dial created within a scope on the slab
+  /// iThread_. Its control block goes to the same slab, and releasing it
+  /// only runs the destructor. A dial from the heap is owned as usual.
+  std::shared_ptr<DialBase> makeDialObject(DialBase* dial_, int iThread_);
+
+  [[nodiscard]] size_t getNbAllocations() const;
+  [[nodiscard]] size_t getAllocatedBytes() const;
+  [[nodiscard]] size_t getReservedBytes() const;
+
+  /// Estimated heap memory the allocations would have taken with malloc
+  /// (chunk headers and rounding included) minus what they take here.
+  [[nodiscard]] long getSavedBytes() const;
+  [[nodiscard]] std::string getSummary() const;
+
+private:
+  struct Block{
+    std::unique_ptr<char[]> data{};
+    size_t size{0};
+  };
+  struct Slab{
+    DialArena* owner{nullptr};
+    char* cursor{nullptr};
+    char* end{nullptr};
+    std::vector<Block> blockList{};
+
+    size_t nbAllocations{0};
+    size_t allocatedBytes{0};
+    size_t reservedBytes{0};
+    size_t mallocBytes{0};
+
+    void* allocate(size_t size_);
+    [[nodiscard]] bool owns(const void* ptr_) const;
+  };
+
+  // allocator of the shared_ptr control blocks
+  template<typename T> struct SlabAllocator;
+
+  size_t _blockSize_;
+  std::vector<Slab> _slabList_{};
+
+};
+
+
+#endif //GUNDAM_DIAL_ARENA_H
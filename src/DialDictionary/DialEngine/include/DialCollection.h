@@ -9,6 +9,8 @@
 #include "DialInterface.h"
 #include "DialInputBuffer.h"
 #include "DialResponseSupervisor.h"
+#include "DialArena.h"
+#include "SplineKnotGrid.h"
 #include "SampleSet.h"
 
 #include "GenericToolbox.Wrappers.h"
@@ -30,9 +32,9 @@ public:
   // and just move the pointers around.
   //
   // Temporarily replace specialty class with shared_ptr.  The shared_ptr
-  // class has the correct semantics (copyable, and deletes the object), but
-  // we don't need the reference counting since we can only have one of each
-  // object.  Also shared_ptr is a bit to memory hungry.
+  // class has the correct semantics (copyable, and deletes the object).  The
+  // reference counting is used when identical dials are interned: the slots
+  // then share a single instance.  Also shared_ptr is a bit to memory hungry.
   typedef std::shared_ptr<DialBase> DialBaseObject;
 
   // setters
@@ -44,6 +46,9 @@ public:
   [[nodiscard]] bool isBinned() const{ return _isBinned_; }
   [[nodiscard]] bool isEnabled() const{ return _isEnabled_; }
   [[nodiscard]] bool isAllowDialExtrapolation() const{ return _allowDialExtrapolation_; }
+  [[nodiscard]] bool isInternIdenticalDials() const{ return _internIdenticalDials_; }
+  [[nodiscard]] bool isShareSplineKnotGrids() const{ return _shareSplineKnotGrids_; }
+  [[nodiscard]] bool isUseDialArena() const{ return _useDialArena_; }
   [[nodiscard]] int getIndex() const{ return _index_; }
   [[nodiscard]] const std::string &getGlobalDialType() const{return _globalDialType_; }
   [[nodiscard]] const std::string &getGlobalDialSubType() const{ return _globalDialSubType_; }
@@ -57,17 +62,23 @@ public:
   std::vector<DialBaseObject> &getDialBaseList(){ return _dialBaseList_; }
   std::vector<DialInterface> &getDialInterfaceList(){ return _dialInterfaceList_; }
   std::vector<DialInputBuffer> &getDialInputBufferList(){ return _dialInputBufferList_; }
+  DialArena* getDialArena(){ return _dialArena_.get(); }
 
   // non-trivial getters
   [[nodiscard]] bool isDatasetValid(const std::string& datasetName_) const;
   std::string getTitle() const;
   std::string getSummary(bool shallow_ = true);
+  /// Estimated memory taken by the dials, their inputs and the containers
+  [[nodiscard]] size_t getMemoryFootprint() const;
   Parameter* getSupervisedParameter() const;
   ParameterSet* getSupervisedParameterSet() const;
 
   // core
   void clear();
   void resizeContainers();
+  void internIdenticalDials();
+  void shareSplineKnotGrids();
+  void tabulateDials();
   void setupDialInterfaceReferences();
   void updateInputBuffers();
   size_t getNextDialFreeSlot();
@@ -90,6 +101,13 @@ private:
   bool _disableDialCache_{false};
   bool _enableDialsSummary_{false};
   bool _allowDialExtrapolation_{true};
+  bool _internIdenticalDials_{false};
+  bool _shareSplineKnotGrids_{false};
+  bool _useDialArena_{false};
+  bool _tabulateDials_{false};
+  int _tabulationMaxPoints_{4097};
+  double _tabulationMaxError_{1E-6};
+  std::string _tabulationInterpolation_{"cubic"};
   int _index_{-1};
   double _minDialResponse_{std::nan("unset")};
   double _maxDialResponse_{std::nan("unset")};
@@ -109,7 +127,10 @@ private:
   std::vector<DialInterface> _dialInterfaceList_{};
   std::vector<DialInputBuffer> _dialInputBufferList_{};
   std::vector<DialResponseSupervisor> _dialResponseSupervisorList_{};
+  // declared before the dials: it has to outlive them
+  std::shared_ptr<DialArena> _dialArena_{nullptr};
   std::vector<DialBaseObject> _dialBaseList_{};
+  std::vector<std::shared_ptr<const SplineKnotGrid>> _splineKnotGridList_{};
   std::shared_ptr<TFormula> _applyConditionFormula_{nullptr};
   GenericToolbox::Atomic<size_t> _dialFreeSlot_{0};
 
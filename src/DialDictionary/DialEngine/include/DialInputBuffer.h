@@ -8,7 +8,9 @@
 #include "ParameterSet.h"
 
 #include <vector>
+#include <atomic>
 #include <utility>
+#include <cstdint>
 
 
 class DialInputBuffer {
@@ -35,6 +37,10 @@ public:
     };
     MirrorEdges mirrorEdges{};
 
+    // value version of the parameter when the buffer was last filled
+    uint64_t valueVersion{_unsetVersion_};
+    static constexpr uint64_t _unsetVersion_{~uint64_t(0)};
+
     [[nodiscard]] const ParameterSet& getParameterSet(std::vector<ParameterSet>* parSetListPtr_) const {
       return (*parSetListPtr_)[parSetIndex];
     }
@@ -62,15 +68,19 @@ public:
   [[nodiscard]] int getBufferSize() const{ return _inputArraySize_; }
   [[nodiscard]] const std::vector<double>& getInputBuffer() const { return _inputBuffer_; }
   [[nodiscard]] const std::vector<ParameterReference> &getInputParameterIndicesList() const{ return _inputParameterReferenceList_; }
-#if USE_ZLIB
-  [[nodiscard]] const uint32_t& getCurrentHash() const{ return _currentHash_; }
-#endif
+
+  /// Stamp identifying the current content of the buffer. A new value is
+  /// drawn from a process-wide counter each time the buffer content changes,
+  /// so two buffers only share an epoch if one is an unmodified copy of the
+  /// other. Used by CachedDial to validate its cached response.
+  [[nodiscard]] uint64_t getEpoch() const{ return _epoch_; }
 
   // mutable getters
 
   /// Function that allow to tweak the buffer from the inside. Used for
-  /// individual spline evaluation.
-  std::vector<double>& getInputBuffer(){ return _inputBuffer_; }
+  /// individual spline evaluation. The buffer is assumed to be modified, so
+  /// the epoch is renewed.
+  std::vector<double>& getInputBuffer(){ this->renewEpoch(); return _inputBuffer_; }
   std::vector<ParameterReference> &getInputParameterIndicesList(){ return _inputParameterReferenceList_; }
 
   // core
@@ -80,7 +90,8 @@ public:
   void initialise();
 
   /// Update the buffer to flag if any parameter has changed, and apply any
-  /// mirroring to the parameter values.
+  /// mirroring to the parameter values. Change detection relies on the value
+  /// version of each parameter, so untouched inputs are not re-read.
   void update();
 
   // nested getters
@@ -101,9 +112,7 @@ public:
   [[deprecated("use getParameterSet()")]] [[nodiscard]] const ParameterSet& getFitParameterSet(int i=0) const { return getParameterSet(i); }
 
 protected:
-#if USE_ZLIB
-  uint32_t generateHash();
-#endif
+  void renewEpoch(){ _epoch_ = ++_epochCounter_; }
 
 private:
   /// Flag if the member can be still edited.
@@ -134,10 +143,13 @@ private:
   /// has one entry)
   std::vector<ParameterReference> _inputParameterReferenceList_{};
 
-#if USE_ZLIB
-  // for cache
-  uint32_t _currentHash_{0};
-#endif
+  /// Current content stamp. 0 is never handed out, so it can be used as
+  /// "unset" by the caches.
+  uint64_t _epoch_{0};
+
+  /// Shared source of epochs. Buffers are updated in single thread, but
+  /// copies can be tweaked from workers (see getInputBuffer()).
+  static std::atomic<uint64_t> _epochCounter_;
 
 };
 
@@ -0,0 +1,105 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_DIAL_PROFILER_H
+#define GUNDAM_DIAL_PROFILER_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+
+/// DialProfiler attributes the cost of the dial evaluations of the
+/// EventDialCache to the dial collections. An entry of the profile is a
+/// (collection, dial type) pair. The threads accumulate their measurements in
+/// their own slot, which are only summed when the profile is printed.
+///
+/// The time is measured per run of consecutive dials of the same entry, so
+/// the clock is read twice per run instead of twice per dial. The hits and
+/// misses of the CachedDial caches are counted in the counters selected by
+/// the Scope active on the evaluating thread.
+class DialProfiler {
+
+public:
+  struct Counters{
+    uint64_t nbEvaluations{0};
+    uint64_t nbSkipped{0};
+    uint64_t nanoseconds{0};
+    uint64_t nbCacheHits{0};
+    uint64_t nbCacheMisses{0};
+
+    void add(const Counters& other_);
+  };
+
+  struct Entry{
+    size_t collectionIndex{0};
+    std::string dialTypeName{};
+    size_t nbDials{0};
+  };
+
+  struct Collection{
+    std::string title{};
+    size_t memoryFootprint{0};
+  };
+
+  /// Route the CachedDial counts of the current thread to counters_ until
+  /// the scope ends.
+  class Scope{
+  public:
+    explicit Scope(Counters* counters_): _previousCounters_(_activeCounters_) { _activeCounters_ = counters_; }
+    ~Scope(){ _activeCounters_ = _previousCounters_; }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  private:
+    Counters* _previousCounters_{nullptr};
+  };
+
+  /// Called by CachedDial. No-op outside a Scope. Unless a profiler has
+  /// been enabled, this is a single test of a plain bool: the thread_local
+  /// lookup is skipped.
+  static void countCacheHit(){ if( _isCountingEnabled_ and _activeCounters_ != nullptr ){ _activeCounters_->nbCacheHits++; } }
+  static void countCacheMiss(){ if( _isCountingEnabled_ and _activeCounters_ != nullptr ){ _activeCounters_->nbCacheMisses++; } }
+
+  /// Must be called outside the threads.
+  void setEnabled( bool isEnabled_ ){ _isEnabled_ = isEnabled_; if( isEnabled_ ){ _isCountingEnabled_ = true; } }
+  [[nodiscard]] bool isEnabled() const { return _isEnabled_; }
+
+  /// Drop the entries and the collections
+  void clear();
+  size_t addCollection( const std::string& title_, size_t memoryFootprint_ );
+  size_t addEntry( size_t collectionIndex_, const std::string& dialTypeName_ );
+  Entry& getEntry( size_t iEntry_ ){ return _entryList_[iEntry_]; }
+  [[nodiscard]] size_t getNbEntries() const { return _entryList_.size(); }
+
+  /// Allocate and zero the counters of each thread. Must be called once the
+  /// entries are defined, outside the threads.
+  void resetCounters( int nbThreads_ );
+  /// iThread_ = -1 is the single thread mode
+  Counters& getCounters( int iThread_, size_t iEntry_ ){ return _threadCounterList_[iThread_ < 0 ? 0 : iThread_][iEntry_]; }
+
+  /// Number of reweights the counters are accumulated over
+  void countCall(){ _nbCalls_++; }
+  [[nodiscard]] size_t getNbCalls() const { return _nbCalls_; }
+
+  /// Tables of the costs per call, per collection (most expensive first) and
+  /// per dial type.
+  [[nodiscard]] std::string getSummary() const;
+
+private:
+  bool _isEnabled_{false};
+  size_t _nbCalls_{0};
+  std::vector<Collection> _collectionList_{};
+  std::vector<Entry> _entryList_{};
+  std::vector<std::vector<Counters>> _threadCounterList_{};
+
+  static thread_local Counters* _activeCounters_;
+  /// Set once any profiler is enabled, never cleared: another profiler may
+  /// still be counting.
+  static bool _isCountingEnabled_;
+
+};
+
+
+#endif //GUNDAM_DIAL_PROFILER_H
@@ -9,6 +9,8 @@
 #include "DialCollection.h"
 #include "Event.h"
 #include "DialInterface.h"
+#include "SplineBatch.h"
+#include "DialProfiler.h"
 
 
 // DEV
@@ -18,6 +20,8 @@
 
 #include <vector>
 #include <utility>
+#include <cstdint>
+#include <cmath>
 
 
 class EventDialCache{
@@ -36,44 +40,78 @@ public:
     }
   };
 
-  /// DialResponseCache is keeping a reference of a DialInterface and a cached double for the response
-  struct DialResponseCache {
-    explicit DialResponseCache( DialInterface& interface_ ): dialInterface(interface_) {}
-    // The dial interface to be used with the PhysicsEvent.
-    DialInterface& dialInterface;
-    // The cached result calculated by the dial.
-    double response{std::nan("unset")};
-
-    void update(){
-      // evaluate the dial if an update has been requested
-      if( dialInterface.getInputBufferRef()->isDialUpdateRequested() ){
-        response = dialInterface.evalResponse();
-      }
-    }
-    double getResponse(){
-      this->update();
-      return response;
-    }
+  /// Index of a DialInterface in the flattened list of dial interfaces.
+  /// 32 bits are enough and halve the memory footprint of the event-dial
+  /// links compared to pointers.
+  typedef uint32_t DialIndex;
+
+  /// Index of an event in the cache.
+  typedef uint32_t EventIndex;
+
+  /// Concrete dial types evaluated without virtual dispatch by the
+  /// two-phase reweight. Any other type (including the cached dials) is
+  /// evaluated through DialBase.
+  enum class DialType : uint8_t {
+    Norm = 0,
+    Shift,
+    CompactSpline,
+    UniformSpline,
+    GeneralSpline,
+    MonotonicSpline,
+    LightGraph,
+    Polynomial,
+    Other
   };
 
-  /// The cache element associating a PhysicsEvent to the appropriate
-  /// DialInterface.
+  /// A range of the flat dial interface list sharing the same DialType. If
+  /// splineBatchIndex is set, the range is evaluated as a SplineBatch.
+  struct DialTypeSegment{
+    DialType dialType{DialType::Other};
+    size_t beginIndex{0};
+    size_t endIndex{0};
+    int splineBatchIndex{-1};
+  };
+
+  /// Light view of one event of the cache: the event and the range of its
+  /// dial indices in the CSR arrays. It does not own anything and stays valid
+  /// as long as the cache is not rebuilt.
   struct CacheEntry {
-    Event* event;
-    std::vector<DialResponseCache> dialResponseCacheList{};
+    Event* event{nullptr};
+    const DialIndex* dialIndexBegin{nullptr};
+    const DialIndex* dialIndexEnd{nullptr};
+    DialInterface* const* dialInterfaceRefList{nullptr};
+
+    [[nodiscard]] size_t getNbDials() const { return dialIndexEnd - dialIndexBegin; }
+    [[nodiscard]] DialInterface& getDialInterface( size_t iDial_ ) const { return *dialInterfaceRefList[dialIndexBegin[iDial_]]; }
 
     [[nodiscard]] std::string getSummary() const {
       std::stringstream ss;
       ss << *event << std::endl;
       ss << "Dials{";
-      for( auto& dialResponseCache : dialResponseCacheList ){
-        ss << std::endl << "  { " << dialResponseCache.dialInterface.getSummary() << " }";
+      for( size_t iDial = 0 ; iDial < getNbDials() ; iDial++ ){
+        ss << std::endl << "  { " << getDialInterface(iDial).getSummary() << " }";
       }
       ss << std::endl << "}";
       return ss.str();
     }
   };
 
+  /// Hands out the [begin, end) ranges of a job to the threads. With a
+  /// chunk size of 0, each thread gets its precomputed slice from
+  /// threadBoundList (or an equal-count slice if not set). Otherwise, the
+  /// threads keep fetching chunks of chunkSize entries until the job is done,
+  /// so the fast threads take over the work of the slow ones.
+  struct WorkDispenser{
+    size_t nEntries{0};
+    size_t chunkSize{0};
+    std::vector<size_t> threadBoundList{};
+    GenericToolbox::Atomic<size_t> nextChunk{0};
+
+    void reset(){ nextChunk.setValue(0); }
+    /// iFetch_ is the number of ranges already fetched by this thread
+    bool fetch( int iThread_, int iFetch_, size_t& begin_, size_t& end_ );
+  };
+
   /// A pair of indices into the vector of dial collections, and then the
   /// index of the dial interfaces in the dial collection vector of dial
   /// interfaces.
@@ -142,18 +180,68 @@ public:
   // returns the current index
   [[nodiscard]] size_t getFillIndex() const { return _fillIndex_; }
 
-  /// Provide the event dial cache.  The event dial cache containes a
-  /// CacheElem_t object for every dial applied to a physics event.  The
-  /// CacheElem_t is a pointer to the PhysicsEvent that will be reweighted and
-  /// a pointer to the DialInterface that will do the reweighting.  Note: Each
-  /// PhysicsEvent will probably be in the cache multiple times (for different
-  /// DialInterface objects), and each DialInterface object could be in the
-  /// cache multiple times (but for different Physics event objects).
-  std::vector<CacheEntry> &getCache(){ return _cache_; }
-  [[nodiscard]] const std::vector<CacheEntry> &getCache() const{ return _cache_; }
+  /// Provide the event dial cache.  The cache is stored in a compressed
+  /// sparse row layout: the dials of the event iEvent_ are the entries
+  /// [ _dialOffsetList_[iEvent_], _dialOffsetList_[iEvent_+1] ) of the dial
+  /// index list.  Each DialInterface can be referenced by many events.
+  [[nodiscard]] size_t getNbEvents() const { return _eventRefList_.size(); }
+  [[nodiscard]] size_t getNbDialLinks() const { return _dialIndexList_.size(); }
+  [[nodiscard]] CacheEntry getCacheEntry( size_t iEvent_ ) const {
+    return {
+        _eventRefList_[iEvent_],
+        _dialIndexList_.data() + _dialOffsetList_[iEvent_],
+        _dialIndexList_.data() + _dialOffsetList_[iEvent_+1],
+        _dialInterfaceRefList_.data()
+    };
+  }
+  [[nodiscard]] const std::vector<Event*>& getEventRefList() const { return _eventRefList_; }
+  [[nodiscard]] const std::vector<size_t>& getDialOffsetList() const { return _dialOffsetList_; }
+  [[nodiscard]] const std::vector<DialIndex>& getDialIndexList() const { return _dialIndexList_; }
+
+  void setEnableTwoPhaseReweight( bool enableTwoPhaseReweight_ ){ _enableTwoPhaseReweight_ = enableTwoPhaseReweight_; }
+  [[nodiscard]] bool isTwoPhaseReweightEnabled() const { return _enableTwoPhaseReweight_; }
+
+  /// Store the dial responses and the knots of the spline batches as float.
+  /// The spline cubics, products and sums stay in double.
+  void setEnableMixedPrecision( bool enableMixedPrecision_ ){ _enableMixedPrecision_ = enableMixedPrecision_; }
+  [[nodiscard]] bool isMixedPrecisionEnabled() const { return _enableMixedPrecision_; }
+
+  /// Evaluate the UniformSpline/CompactSpline dials sharing the same input
+  /// and knot grid as batches (see SplineBatch).
+  void setEnableSplineBatches( bool enableSplineBatches_ ){ _enableSplineBatches_ = enableSplineBatches_; }
+  [[nodiscard]] bool isSplineBatchesEnabled() const { return _enableSplineBatches_; }
+
+  /// Sort the MC events of each sample by (bin, dataset, entry) instead of
+  /// (dataset, entry) while building the cache.
+  void setSortEventsByBin( bool sortEventsByBin_ ){ _sortEventsByBin_ = sortEventsByBin_; }
+  [[nodiscard]] bool isSortEventsByBin() const { return _sortEventsByBin_; }
+
+  void setEnableIncrementalReweight( bool enableIncrementalReweight_ ){ _enableIncrementalReweight_ = enableIncrementalReweight_; }
+  void setIncrementalReweightMaxFraction( double incrementalReweightMaxFraction_ ){ _incrementalReweightMaxFraction_ = incrementalReweightMaxFraction_; }
+  [[nodiscard]] bool isIncrementalReweightEnabled() const { return _enableIncrementalReweight_; }
+  [[nodiscard]] double getIncrementalReweightMaxFraction() const { return _incrementalReweightMaxFraction_; }
+
+  /// The next call to prepareIncrementalReweight() will request a full
+  /// reweight. To be called if the event weights have been modified outside
+  /// the cache.
+  void requestFullReweight(){ _isFullReweightRequested_ = true; }
+
+  /// Size of the chunks dynamically fetched by the threads. If 0, the events
+  /// are split in static slices balanced on their number of dials.
+  void setThreadChunkSize( size_t threadChunkSize_ ){ _eventDispenser_.chunkSize = threadChunkSize_; _dialDispenser_.chunkSize = threadChunkSize_; }
+  [[nodiscard]] size_t getThreadChunkSize() const { return _eventDispenser_.chunkSize; }
+  WorkDispenser& getEventDispenser(){ return _eventDispenser_; }
+  /// Must be called before each parallel job using the dispensers
+  void resetWorkDispensers(){ _eventDispenser_.reset(); _dialDispenser_.reset(); }
 
   GlobalEventReweightCap& getGlobalEventReweightCap(){ return _globalEventReweightCap_; }
 
+  /// Attribute the time and the number of evaluations of the two-phase and
+  /// incremental reweights to the dial collections. Must be enabled before
+  /// the cache is built.
+  DialProfiler& getDialProfiler(){ return _dialProfiler_; }
+  [[nodiscard]] const DialProfiler& getDialProfiler() const { return _dialProfiler_; }
+
   /// Allocate entries for events in the indexed cache.  The first parameter
   /// arethe number of events to allocate space for, and the second number is
   /// the total number of dials that might exist for each event.
@@ -174,10 +262,76 @@ public:
   /// Resize the cache vectors to remove entries with null events
   void shrinkIndexedCache();
 
-  void reweightEntry( CacheEntry& entry_);
+  /// Reweight the event iEvent_ of the cache. If the two-phase reweight is
+  /// enabled, the dial responses must have been evaluated beforehand with
+  /// updateDialResponses() and are only gathered here. Otherwise, each
+  /// event-dial link keeps its own cached response (legacy behaviour).
+  void reweightEntry( size_t iEvent_ );
+
+  /// Two-phase reweight. First, every DialInterface referenced by the cache
+  /// is evaluated once (if its inputs have changed) and the result is stored
+  /// in a flat response list. Then each event only has to gather and multiply
+  /// the responses of its dials. A binned dial shared by N events is
+  /// therefore evaluated once instead of N times.
+  void updateDialResponses( int iThread_ = -1 );
+
+  /// Evaluate the reweight factor of an event from scratch, in double
+  /// precision and without touching any cache. Used for validation.
+  [[nodiscard]] double evalEntryReweight( size_t iEvent_ ) const;
+
+  /// Incremental reweight. Once the input buffers have been updated, this
+  /// collects the dials and the events depending on the inputs that have
+  /// changed using the inverted index built along with the cache. Returns
+  /// false if a full reweight is needed instead: incremental mode disabled,
+  /// first call after the cache has been built, or too many events touched.
+  bool prepareIncrementalReweight();
+  /// Evaluate the dials / reweight the events collected by
+  /// prepareIncrementalReweight(). All the other events keep their weight.
+  void updateDirtyDialResponses( int iThread_ = -1 );
+  void reweightDirtyEntries( int iThread_ = -1 );
+  [[nodiscard]] const std::vector<EventIndex>& getDirtyEventList() const { return _dirtyEventList_; }
+
+  [[nodiscard]] const std::vector<DialInterface*>& getDialInterfaceRefList() const { return _dialInterfaceRefList_; }
 
 
 private:
+  static DialType getDialType( const DialBase* dialBase_ );
+  /// Rough relative cost of a dial evaluation, only used to balance the
+  /// incremental reweight between the threads.
+  static float getDialTypeCost( DialType dialType_ );
+
+  /// Evaluate the dials [begin_, end_) of the flat list, which must all be
+  /// of the concrete type T (or any type if T is DialBase).
+  template<typename T> void updateDialResponseRange( size_t begin_, size_t end_ );
+  /// Evaluate the dials [begin_, end_) of a spline batch segment
+  void updateSplineBatchRange( const DialTypeSegment& segment_, size_t begin_, size_t end_ );
+  /// Evaluate the dials [begin_, end_) of a segment with the loop of its type
+  void updateSegmentRange( const DialTypeSegment& segment_, size_t begin_, size_t end_ );
+  /// Same, timing each run of dials of the same profile entry
+  void updateProfiledSegmentRange( int iThread_, const DialTypeSegment& segment_, size_t begin_, size_t end_ );
+  /// Split the spline segments of the sorted flat list into batches
+  void buildSplineBatches();
+
+  /// Access the flat response list in the selected precision
+  [[nodiscard]] inline bool isDialResponseSet( size_t iDial_ ) const {
+    return _enableMixedPrecision_ ? not std::isnan(_dialResponseFloatList_[iDial_]) : not std::isnan(_dialResponseList_[iDial_]);
+  }
+  inline void setDialResponse( size_t iDial_, double response_ ){
+    if( _enableMixedPrecision_ ){ _dialResponseFloatList_[iDial_] = float(response_); }
+    else{ _dialResponseList_[iDial_] = response_; }
+  }
+
+  /// Build the CSR arrays from the dial input buffers to the dials and the
+  /// events of the cache. Only needed by the incremental reweight.
+  void buildInvertedIndex();
+
+  /// Define the profile entries of the sorted flat dial list.
+  /// dialCollectionIndexList_[i] is the collection of the i-th dial.
+  void buildDialProfile( std::vector<DialCollection>& dialCollectionList_, const std::vector<size_t>& dialCollectionIndexList_ );
+  [[nodiscard]] inline bool isDialProfilingActive() const {
+    return _dialProfiler_.isEnabled() and _dialProfileEntryList_.size() == _dialInterfaceRefList_.size();
+  }
+
   // The next available entry in the indexed cache.
   size_t _fillIndex_{0};
 
@@ -188,12 +342,70 @@ private:
   // and dials.
   std::vector<IndexedCacheEntry> _indexedCache_{};
 
+  bool _enableTwoPhaseReweight_{true};
+  bool _sortEventsByBin_{false};
+
   /// A cache of all of the valid PhysicsEvent* and DialInterface*
-  /// associations for efficient use when reweighting the MC events.
-  std::vector<CacheEntry> _cache_{};
+  /// associations for efficient use when reweighting the MC events. The
+  /// dial indices of the event i are stored in
+  /// _dialIndexList_[ _dialOffsetList_[i] : _dialOffsetList_[i+1] ].
+  std::vector<Event*> _eventRefList_{};
+  std::vector<size_t> _dialOffsetList_{};
+  std::vector<DialIndex> _dialIndexList_{};
+
+  /// Per event-dial link response. Only allocated if the two-phase reweight
+  /// is disabled.
+  std::vector<double> _dialLinkResponseList_{};
+
+  /// Every DialInterface of the dial collections, flattened. The response
+  /// of _dialInterfaceRefList_[i] is stored in _dialResponseList_[i].
+  std::vector<DialInterface*> _dialInterfaceRefList_{};
+  /// The flat list is sorted by dial type. Each segment is evaluated by a
+  /// loop specialized for its type.
+  std::vector<DialTypeSegment> _dialTypeSegmentList_{};
+  std::vector<double> _dialResponseList_{};
+  /// Used instead of _dialResponseList_ in mixed precision mode
+  bool _enableMixedPrecision_{false};
+  std::vector<float> _dialResponseFloatList_{};
+
+  /// Spline batches. Runs shorter than _splineBatchMinSize_ are evaluated
+  /// dial by dial.
+  bool _enableSplineBatches_{false};
+  static constexpr size_t _splineBatchMinSize_{16};
+  std::vector<SplineBatch> _splineBatchList_{};
+
+  /// Incremental reweight. The dial input buffers are flattened, and for
+  /// each of them the dials and the events depending on it are stored in
+  /// CSR arrays (inverted index).
+  bool _enableIncrementalReweight_{false};
+  bool _isFullReweightRequested_{true};
+  double _incrementalReweightMaxFraction_{0.2};
+  std::vector<DialInputBuffer*> _inputBufferRefList_{};
+  std::vector<size_t> _bufferDialOffsetList_{};
+  std::vector<DialIndex> _bufferDialIndexList_{};
+  std::vector<size_t> _bufferEventOffsetList_{};
+  std::vector<EventIndex> _bufferEventIndexList_{};
+  std::vector<DialIndex> _dirtyDialList_{};
+  std::vector<EventIndex> _dirtyEventList_{};
+  std::vector<uint8_t> _isEventDirtyList_{};
+  /// The dirty lists are split between the threads on their cost: per dial
+  /// (getDialTypeCost) and per event (number of dials + 1).
+  std::vector<float> _dialCostList_{};
+  std::vector<double> _dirtyCostList_{};
+  std::vector<size_t> _dirtyDialBoundList_{};
+  std::vector<size_t> _dirtyEventBoundList_{};
+
+  /// Thread partitioning of the events and the dial interfaces
+  WorkDispenser _eventDispenser_{};
+  WorkDispenser _dialDispenser_{};
 
   /// Global cap
   GlobalEventReweightCap _globalEventReweightCap_{};
+
+  /// Profiling. _dialProfileEntryList_[i] is the profile entry of the i-th
+  /// dial of the flat list.
+  DialProfiler _dialProfiler_{};
+  std::vector<uint32_t> _dialProfileEntryList_{};
 };
 
 
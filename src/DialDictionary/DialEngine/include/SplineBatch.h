@@ -0,0 +1,87 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_SPLINE_BATCH_H
+#define GUNDAM_SPLINE_BATCH_H
+
+#include "DialInterface.h"
+#include "DialInputBuffer.h"
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <cmath>
+
+
+/// SplineBatch evaluates together a group of UniformSpline or CompactSpline
+/// dials reading the same input buffer and defined on the same knot grid.
+/// The knot segment and the fractional position within the segment only
+/// depend on the input value and the grid, so they are computed once for the
+/// whole batch. The cubic is then evaluated for all the dials in a single
+/// loop over a structure-of-arrays copy of the knot data.
+///
+/// The loop is compiled for several instruction sets (AVX-512, AVX2 and a
+/// scalar fallback) when the compiler supports it, and the best version for
+/// the running CPU is picked at load time.
+class SplineBatch{
+
+public:
+  enum class SplineType : uint8_t { UniformSpline, CompactSpline };
+
+  SplineBatch() = default;
+
+  /// Return true if the dial is a UniformSpline or a CompactSpline (exact
+  /// type) that can be part of a batch.
+  static bool isBatchable( const DialInterface& dialInterface_ );
+
+  /// Return true if the two batchable dials can share the same batch.
+  static bool isSameBatch( const DialInterface& a_, const DialInterface& b_ );
+
+  /// Name of the instruction set selected for the batched loops
+  static std::string getInstructionSetName();
+
+  /// Copy the knot data of the dials. All of them must be batchable and
+  /// belong to the same batch. With useFloat_, the knot data is stored as
+  /// float (the cubic is still evaluated in double).
+  void build( DialInterface* const* dialInterfaceList_, size_t nDials_, bool useFloat_ = false );
+
+  /// Evaluate the responses of the dials [begin_, end_) of the batch for
+  /// the current input value. The responses are conditioned as the
+  /// DialResponseSupervisor would do.
+  void eval( size_t begin_, size_t end_, double* responseList_ ) const;
+
+  [[nodiscard]] size_t getNbDials() const { return _nbDials_; }
+  [[nodiscard]] const DialInputBuffer* getInputBufferRef() const { return _inputBufferRef_; }
+
+private:
+  SplineType _splineType_{SplineType::UniformSpline};
+  size_t _nbDials_{0};
+  int _nbKnots_{0};
+
+  /// Grid shared by all the dials of the batch
+  double _lowerBound_{std::nan("unset")};
+  double _step_{std::nan("unset")};
+  bool _allowExtrapolation_{false};
+  std::pair<double, double> _splineBounds_{std::nan("unset"), std::nan("unset")};
+
+  /// Response conditioning of the supervisor. Unset bounds are stored as
+  /// infinities so the clamping never branches.
+  double _minResponse_{-INFINITY};
+  double _maxResponse_{INFINITY};
+
+  const DialInputBuffer* _inputBufferRef_{nullptr};
+
+  /// Knot data: the value (and slope for UniformSpline) of the knot k of the
+  /// dial i is stored at [k*_nbDials_ + i].
+  std::vector<double> _valueList_{};
+  std::vector<double> _slopeList_{};
+  /// Used instead of _valueList_ and _slopeList_ in mixed precision mode
+  bool _useFloat_{false};
+  std::vector<float> _valueFloatList_{};
+  std::vector<float> _slopeFloatList_{};
+};
+
+
+#endif //GUNDAM_SPLINE_BATCH_H
@@ -0,0 +1,132 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "DialArena.h"
+
+#include "Logger.h"
+
+#include <sstream>
+#include <algorithm>
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[DialArena]");
+});
+
+namespace {
+  constexpr size_t alignment{alignof(double) > alignof(void*) ? alignof(double) : alignof(void*)};
+
+  size_t roundUp(size_t size_, size_t alignment_){ return (size_ + alignment_ - 1) / alignment_ * alignment_; }
+
+  // glibc: 8 bytes of chunk header, 16 bytes granularity, 32 bytes minimum
+  size_t mallocChunkSize(size_t size_){ return std::max(size_t(32), roundUp(size_ + 8, 16)); }
+
+  // the memory of a dial is released with the arena
+  struct DestroyOnly{ void operator()(DialBase* dial_) const { dial_->~DialBase(); } };
+
+  // the slab receiving the dial allocations of this thread
+  thread_local void* activeSlab{nullptr};
+}
+
+template<typename T> struct DialArena::SlabAllocator{
+  typedef T value_type;
+  Slab* slab;
+  explicit SlabAllocator(Slab* slab_): slab(slab_) {}
+  template<typename U> explicit SlabAllocator(const SlabAllocator<U>& other_): slab(other_.slab) {}
+  T* allocate(size_t n_){ return static_cast<T*>(slab->allocate(n_*sizeof(T))); }
+  void deallocate(T*, size_t){}
+  template<typename U> bool operator==(const SlabAllocator<U>& other_) const { return slab == other_.slab; }
+  template<typename U> bool operator!=(const SlabAllocator<U>& other_) const { return slab != other_.slab; }
+};
+
+DialArena::Scope::Scope(DialArena* arena_, int iThread_): _previousSlab_(activeSlab) {
+  if( arena_ == nullptr ){ activeSlab = nullptr; return; }
+  LogThrowIf(iThread_ < 0 or size_t(iThread_) >= arena_->_slabList_.size(),
+             "No slab for thread #" << iThread_ << " in the dial arena (" << arena_->_slabList_.size() << " slabs).");
+  activeSlab = &arena_->_slabList_[iThread_];
+}
+DialArena::Scope::~Scope(){ activeSlab = _previousSlab_; }
+
+void DialArena::setNbThreads(int nbThreads_){
+  if( nbThreads_ < 1 ){ nbThreads_ = 1; }
+  if( _slabList_.size() >= size_t(nbThreads_) ){ return; }
+  _slabList_.resize(nbThreads_);
+  for( auto& slab : _slabList_ ){ slab.owner = this; }
+}
+
+void* DialArena::Slab::allocate(size_t size_){
+  const size_t totalSize{roundUp(size_, alignment)};
+  if( cursor == nullptr or size_t(end - cursor) < totalSize ){
+    // objects larger than a block get a dedicated one
+    const size_t blockSize{std::max(owner->_blockSize_, totalSize)};
+    blockList.emplace_back();
+    blockList.back().data.reset( new char[blockSize] );
+    blockList.back().size = blockSize;
+    cursor = blockList.back().data.get();
+    end = cursor + blockSize;
+    reservedBytes += blockSize;
+  }
+  char* out{cursor};
+  cursor += totalSize;
+
+  nbAllocations++;
+  allocatedBytes += totalSize;
+  mallocBytes += mallocChunkSize(size_);
+  return out;
+}
+
+bool DialArena::Slab::owns(const void* ptr_) const {
+  auto* ptr = static_cast<const char*>(ptr_);
+  // the latest block first: that's where the dial being handled usually is
+  for( auto block = blockList.rbegin() ; block != blockList.rend() ; ++block ){
+    if( ptr >= block->data.get() and ptr < block->data.get() + block->size ){ return true; }
+  }
+  return false;
+}
+
+void* DialArena::allocate(size_t size_){
+  if( activeSlab != nullptr ){ return static_cast<Slab*>(activeSlab)->allocate(size_); }
+  return ::operator new(size_);
+}
+void DialArena::deallocate(void* ptr_){
+  if( ptr_ == nullptr ){ return; }
+  // the arena memory is released with the arena
+  if( activeSlab != nullptr and static_cast<Slab*>(activeSlab)->owns(ptr_) ){ return; }
+  ::operator delete(ptr_);
+}
+
+std::shared_ptr<DialBase> DialArena::makeDialObject(DialBase* dial_, int iThread_){
+  LogThrowIf(iThread_ < 0 or size_t(iThread_) >= _slabList_.size(),
+             "No slab for thread #" << iThread_ << " in the dial arena (" << _slabList_.size() << " slabs).");
+  auto* slab = &_slabList_[iThread_];
+  if( not slab->owns(dial_) ){ return std::shared_ptr<DialBase>(dial_); }
+  return {dial_, DestroyOnly(), SlabAllocator<DialBase>(slab)};
+}
+
+size_t DialArena::getNbAllocations() const {
+  size_t out{0};
+  for( auto& slab : _slabList_ ){ out += slab.nbAllocations; }
+  return out;
+}
+size_t DialArena::getAllocatedBytes() const {
+  size_t out{0};
+  for( auto& slab : _slabList_ ){ out += slab.allocatedBytes; }
+  return out;
+}
+size_t DialArena::getReservedBytes() const {
+  size_t out{0};
+  for( auto& slab : _slabList_ ){ out += slab.reservedBytes; }
+  return out;
+}
+long DialArena::getSavedBytes() const {
+  long out{0};
+  for( auto& slab : _slabList_ ){ out += long(slab.mallocBytes) - long(slab.reservedBytes); }
+  return out;
+}
+std::string DialArena::getSummary() const {
+  std::stringstream ss;
+  ss << getNbAllocations() << " allocations, " << double(getAllocatedBytes())/1E6 << " MB used of "
+     << double(getReservedBytes())/1E6 << " MB reserved in " << _slabList_.size() << " thread slabs, "
+     << double(getSavedBytes())/1E6 << " MB saved over malloc";
+  return ss.str();
+}
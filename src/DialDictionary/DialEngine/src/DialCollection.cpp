@@ -5,11 +5,19 @@
 #include "GundamGlobals.h"
 #include "DialCollection.h"
 #include "DialBaseFactory.h"
+#include "GeneralSpline.h"
 
 #include "GenericToolbox.Json.h"
 #include "Logger.h"
 
+#include <map>
+#include <tuple>
 #include <sstream>
+#include <typeinfo>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
 
 
 LoggerInit([]{
@@ -112,6 +120,25 @@ std::string DialCollection::getSummary(bool shallow_){
 
   return ss.str();
 }
+size_t DialCollection::getMemoryFootprint() const{
+  size_t out{0};
+  out += _dialInterfaceList_.capacity() * sizeof(DialInterface);
+  out += _dialInputBufferList_.capacity() * sizeof(DialInputBuffer);
+  out += _dialResponseSupervisorList_.capacity() * sizeof(DialResponseSupervisor);
+  out += _dialBaseList_.capacity() * sizeof(DialBaseObject);
+  for( auto& knotGrid : _splineKnotGridList_ ){
+    if( knotGrid == nullptr ){ continue; }
+    out += sizeof(SplineKnotGrid) + knotGrid->getKnotList().capacity() * sizeof(double);
+  }
+
+  // the interned dials are only counted once
+  std::unordered_set<const DialBase*> dialSet{};
+  for( auto& dialBase : _dialBaseList_ ){
+    if( dialBase == nullptr or not dialSet.insert( dialBase.get() ).second ){ continue; }
+    out += dialBase->getMemoryFootprint();
+  }
+  return out;
+}
 Parameter* DialCollection::getSupervisedParameter() const {
   auto* parSetPtr = this->getSupervisedParameterSet();
   if( parSetPtr == nullptr ) return nullptr;
@@ -131,6 +158,9 @@ void DialCollection::clear(){
   _dialBaseList_.clear();
   _dialInterfaceList_.shrink_to_fit();
   _dialBaseList_.shrink_to_fit();
+  _splineKnotGridList_.clear();
+  // the dials are gone: start a new arena
+  if( _dialArena_ != nullptr ){ _dialArena_ = std::make_shared<DialArena>(); }
   _dialFreeSlot_.setValue(0);
 }
 void DialCollection::resizeContainers(){
@@ -140,7 +170,101 @@ void DialCollection::resizeContainers(){
   _dialBaseList_.resize(_dialFreeSlot_.getValue());
   _dialInterfaceList_.shrink_to_fit();
   _dialBaseList_.shrink_to_fit();
+  if( _shareSplineKnotGrids_ ){ this->shareSplineKnotGrids(); }
+  if( _internIdenticalDials_ ){ this->internIdenticalDials(); }
   this->setupDialInterfaceReferences();
+  if( _dialArena_ != nullptr ){
+    LogInfo << "Dial arena of \"" << this->getTitle() << "\": " << _dialArena_->getSummary() << std::endl;
+  }
+}
+void DialCollection::internIdenticalDials(){
+  // Replace the dials having the same content by a single shared instance.
+  // The candidates are found with a hash of the dial type and data, then
+  // compared by the dials themselves.
+  auto hashDial = [](const DialBase& dial_){
+    size_t hash{typeid(dial_).hash_code()};
+    hash ^= std::hash<bool>{}(dial_.getAllowExtrapolation()) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    for( double value : dial_.getDialData() ){
+      hash ^= std::hash<double>{}(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+  };
+
+  size_t nInterned{0};
+  size_t nDataBytes{0};
+  std::unordered_map<size_t, std::vector<size_t>> candidateListMap{};
+  candidateListMap.reserve( _dialBaseList_.size() );
+  for( size_t iDial = 0 ; iDial < _dialBaseList_.size() ; iDial++ ){
+    auto& dial = _dialBaseList_[iDial];
+    if( dial == nullptr ){ continue; }
+
+    // dials that can't compare their content are kept as is
+    if( not dial->isIdentical(*dial) ){ continue; }
+
+    auto& candidateList = candidateListMap[hashDial(*dial)];
+    auto canonical = std::find_if(candidateList.begin(), candidateList.end(), [&](size_t iCandidate_){
+      return _dialBaseList_[iCandidate_]->isIdentical(*dial);
+    });
+    if( canonical == candidateList.end() ){
+      candidateList.emplace_back( iDial );
+      continue;
+    }
+
+    nInterned++;
+    nDataBytes += dial->getDialData().size() * sizeof(double);
+    dial = _dialBaseList_[*canonical];
+  }
+
+  LogInfo << "Interned " << nInterned << "/" << _dialBaseList_.size() << " identical dials of \""
+          << this->getTitle() << "\" (" << double(nDataBytes)/1E6 << " MB of dial data released)" << std::endl;
+}
+void DialCollection::shareSplineKnotGrids(){
+  // Move the knot positions of the general splines to grids shared by all
+  // the splines of the collection having the same knots.
+  auto hashKnotList = [](const std::vector<double>& knotList_){
+    size_t hash{knotList_.size()};
+    for( double knot : knotList_ ){
+      hash ^= std::hash<double>{}(knot) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+  };
+
+  // grids from a previous call are reused
+  std::unordered_map<size_t, std::vector<const SplineKnotGrid*>> gridListMap{};
+  for( auto& knotGrid : _splineKnotGridList_ ){
+    gridListMap[hashKnotList(knotGrid->getKnotList())].emplace_back( knotGrid.get() );
+  }
+
+  size_t nSplines{0};
+  size_t nDataBytes{0};
+  std::vector<double> knotList{};
+  for( auto& dial : _dialBaseList_ ){
+    auto* spline = dynamic_cast<GeneralSpline*>(dial.get());
+    if( spline == nullptr or spline->getKnotGrid() != nullptr ){ continue; }
+
+    auto& data = spline->getDialData();
+    if( data.size() < 2 + 3*2 or (data.size()-2)%3 != 0 ){ continue; }
+    knotList.resize( (data.size()-2)/3 );
+    for( size_t iKnot = 0 ; iKnot < knotList.size() ; iKnot++ ){ knotList[iKnot] = data[2 + 3*iKnot + 2]; }
+    if( std::adjacent_find(knotList.begin(), knotList.end(), std::greater_equal<>()) != knotList.end() ){ continue; }
+
+    auto& gridList = gridListMap[hashKnotList(knotList)];
+    auto knotGrid = std::find_if(gridList.begin(), gridList.end(), [&](const SplineKnotGrid* grid_){
+      return grid_->getKnotList() == knotList;
+    });
+    if( knotGrid == gridList.end() ){
+      _splineKnotGridList_.emplace_back( std::make_shared<const SplineKnotGrid>(knotList) );
+      gridList.emplace_back( _splineKnotGridList_.back().get() );
+      knotGrid = gridList.end() - 1;
+    }
+
+    nSplines++;
+    nDataBytes += knotList.size() * sizeof(double);
+    spline->setKnotGrid( *knotGrid );
+  }
+
+  LogInfo << "Shared knot grids of \"" << this->getTitle() << "\": " << nSplines << " splines on "
+          << _splineKnotGridList_.size() << " grids (" << double(nDataBytes)/1E6 << " MB of knot positions released)" << std::endl;
 }
 void DialCollection::updateInputBuffers(){
   std::for_each(_dialInputBufferList_.begin(), _dialInputBufferList_.end(), [](DialInputBuffer& i_){
@@ -248,7 +372,68 @@ void DialCollection::setupDialInterfaceReferences(){
     }
   }
 
+  if( _tabulateDials_ ){ this->tabulateDials(); }
+}
+void DialCollection::tabulateDials(){
+  // Replace the dials that are expensive to evaluate by an interpolation
+  // table over the range of their input.
+  auto isCheapDial = [](const DialBase& dial_){
+    // includes the cached versions
+    static const std::vector<std::string> cheapDialTypeList{
+        "Norm", "Shift", "LightGraph",
+        "UniformSpline", "CompactSpline", "GeneralSpline", "MonotonicSpline", "SimpleSpline"
+    };
+    return GenericToolbox::doesElementIsInVector(dial_.getDialTypeName(), cheapDialTypeList);
+  };
+
+  // The interned dials (see internIdenticalDials) are shared by several
+  // slots: each of them is tabulated once per input range. The original
+  // dials are kept in the map so their address can't be reused.
+  struct TabulatedDial{ DialBaseObject original{}; DialBaseObject table{}; };
+  std::map<std::tuple<const DialBase*, double, double>, TabulatedDial> tabulatedDialMap{};
+
+  size_t nTabulated{0};
+  size_t nFailed{0};
+  size_t nUnbounded{0};
+  DialBaseFactory factory{};
+  for( size_t iDial = 0 ; iDial < _dialBaseList_.size() ; iDial++ ){
+    auto& dial = _dialBaseList_[iDial];
+    if( dial == nullptr or isCheapDial(*dial) ){ continue; }
+
+    auto* inputBuffer = _dialInterfaceList_[iDial].getInputBufferRef();
+    if( inputBuffer == nullptr or inputBuffer->getBufferSize() != 1 ){ continue; }
+
+    // The table doesn't extrapolate, so the input must not be able to leave
+    // it: the mirror range, or the limits of the parameter. Dials of
+    // parameters without limits are evaluated directly.
+    double min{_mirrorLowEdge_};
+    double max{_mirrorHighEdge_};
+    if( not _useMirrorDial_ ){
+      min = inputBuffer->getParameter(0).getMinValue();
+      max = inputBuffer->getParameter(0).getMaxValue();
+    }
+    if( not std::isfinite(min) or not std::isfinite(max) or not (min < max) ){ nUnbounded++; continue; }
+
+    auto& tabulatedDial = tabulatedDialMap[std::make_tuple(dial.get(), min, max)];
+    if( tabulatedDial.original == nullptr ){
+      tabulatedDial.original = dial;
+      tabulatedDial.table = DialBaseObject(factory.makeTabulatedDial(
+          *dial, *inputBuffer, min, max, _tabulationInterpolation_, _tabulationMaxError_, _tabulationMaxPoints_
+      ));
+      if( tabulatedDial.table == nullptr ){ nFailed++; } else { nTabulated++; }
+    }
+    if( tabulatedDial.table == nullptr ){ continue; }
+
+    dial = tabulatedDial.table;
+    _dialInterfaceList_[iDial].setDialBaseRef( dial.get() );
+  }
 
+  LogWarningIf(nUnbounded != 0) << nUnbounded << " dials of \"" << this->getTitle()
+                                << "\" are not tabulated: their parameter has no limits." << std::endl;
+  if( nTabulated + nFailed == 0 ){ return; }
+  LogInfo << "Tabulated " << nTabulated << " dials of \"" << this->getTitle() << "\" with "
+          << _tabulationInterpolation_ << " interpolation (" << nFailed << " kept as they are: max error above "
+          << _tabulationMaxError_ << " or invalid response)" << std::endl;
 }
 size_t DialCollection::getNextDialFreeSlot(){
   return _dialFreeSlot_++;
@@ -387,6 +572,16 @@ void DialCollection::readGlobals(const JsonType &config_) {
   }
 
   _allowDialExtrapolation_ = GenericToolbox::Json::fetchValue(config_, "allowDialExtrapolation", _allowDialExtrapolation_);
+
+  _internIdenticalDials_ = GenericToolbox::Json::fetchValue(config_, "internIdenticalDials", _internIdenticalDials_);
+  _shareSplineKnotGrids_ = GenericToolbox::Json::fetchValue(config_, "shareSplineKnotGrids", _shareSplineKnotGrids_);
+  _useDialArena_ = GenericToolbox::Json::fetchValue(config_, "useDialArena", _useDialArena_);
+  if( _useDialArena_ and _dialArena_ == nullptr ){ _dialArena_ = std::make_shared<DialArena>(); }
+
+  _tabulateDials_ = GenericToolbox::Json::fetchValue(config_, "tabulateDials", _tabulateDials_);
+  _tabulationInterpolation_ = GenericToolbox::Json::fetchValue(config_, "tabulationInterpolation", _tabulationInterpolation_);
+  _tabulationMaxError_ = GenericToolbox::Json::fetchValue(config_, "tabulationMaxError", _tabulationMaxError_);
+  _tabulationMaxPoints_ = GenericToolbox::Json::fetchValue(config_, "tabulationMaxPoints", _tabulationMaxPoints_);
 }
 bool DialCollection::initializeNormDialsWithParBinning() {
   auto binning = GenericToolbox::Json::fetchValue(_config_, "parametersBinningPath", JsonType());
@@ -445,6 +640,12 @@ bool DialCollection::initializeDialsWithDefinition() {
     DialBaseFactory f;
     _dialBaseList_.emplace_back( DialBaseObject( f.makeDial( dialsDefinition ) ) );
   }
+  else if( _globalDialType_ == "Grid" and GenericToolbox::Json::doKeyExist(dialsDefinition, "dialConfig") ){
+    // A single grid dial defined by a knot table
+    DialBaseFactory f;
+    _dialBaseList_.emplace_back( DialBaseObject( f.makeDial( dialsDefinition ) ) );
+    _dialBaseList_.back()->setAllowExtrapolation(_allowDialExtrapolation_);
+  }
   else {
     if     (not _globalDialLeafName_.empty()) {
       // The dialLeafName field has been provided, so this is an event by
@@ -6,17 +6,17 @@
 
 #include "Logger.h"
 
-#if USE_ZLIB
-#include "zlib.h"
-#endif
-
 LoggerInit([]{
   Logger::setUserHeaderStr("[DialInputBuffer]");
 });
 
+std::atomic<uint64_t> DialInputBuffer::_epochCounter_{0};
+
 void DialInputBuffer::invalidateBuffers(){
   // invalidate buffer
   for( auto& buf : _inputBuffer_ ){ buf = std::nan("unset"); }
+  for( auto& parRef : _inputParameterReferenceList_ ){ parRef.valueVersion = ParameterReference::_unsetVersion_; }
+  this->renewEpoch();
 }
 
 void DialInputBuffer::initialise(){
@@ -44,6 +44,7 @@ void DialInputBuffer::initialise(){
                "Parameter index invalid: " << _inputParameterReferenceList_[iInput].parIndex);
   }
 
+  this->renewEpoch();
   _isInitialized_ = true;
 }
 
@@ -63,8 +64,14 @@ void DialInputBuffer::update(){
   double tempBuffer;
   _isDialUpdateRequested_ = false; // if ANY is different, request the update
   for( auto& inputRef : _inputParameterReferenceList_ ){
+    auto& par = inputRef.getParameter(_parSetListPtr_);
+
+    // integer compare: nothing to do if the parameter hasn't been touched
+    if( par.getValueVersion() == inputRef.valueVersion ){ continue; }
+    inputRef.valueVersion = par.getValueVersion();
+
     // grab the value of the parameter
-    tempBuffer = inputRef.getParameter(_parSetListPtr_).getParameterValue();
+    tempBuffer = par.getParameterValue();
 
     // find the actual parameter value if mirroring is applied
     if( not std::isnan( inputRef.mirrorEdges.minValue ) ){
@@ -90,9 +97,9 @@ void DialInputBuffer::update(){
     }
   }
 
-#if USE_ZLIB
-  _currentHash_ = generateHash();
-#endif
+  // any cached response computed with the previous values is now stale
+  if( _isDialUpdateRequested_ ){ this->renewEpoch(); }
+
 }
 void DialInputBuffer::addParameterReference( const ParameterReference& parReference_){
   LogThrowIf(_isInitialized_, "Can't add parameter index while initialized.");
@@ -122,15 +129,3 @@ std::string DialInputBuffer::getSummary() const{
 
   return ss.str();
 }
-
-#if USE_ZLIB
-uint32_t DialInputBuffer::generateHash(){
-  uint32_t out = crc32(0L, Z_NULL, 0);
-  double* inputPtr = _inputBuffer_.data();
-  while( inputPtr < _inputBuffer_.data() + _inputBuffer_.size() ){
-    out = crc32( out, (const Bytef*) inputPtr, sizeof(double) );
-    inputPtr++;
-  }
-  return out;
-}
-#endif
@@ -0,0 +1,145 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "DialProfiler.h"
+
+#include "GenericToolbox.Utils.h"
+
+#include <map>
+#include <sstream>
+#include <numeric>
+#include <iomanip>
+#include <algorithm>
+
+
+thread_local DialProfiler::Counters* DialProfiler::_activeCounters_{nullptr};
+bool DialProfiler::_isCountingEnabled_{false};
+
+namespace {
+  std::string formatTime(double nanoseconds_){
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    if( nanoseconds_ >= 1E6 ){ ss << nanoseconds_/1E6 << " ms"; }
+    else if( nanoseconds_ >= 1E3 ){ ss << nanoseconds_/1E3 << " us"; }
+    else{ ss << nanoseconds_ << " ns"; }
+    return ss.str();
+  }
+  std::string formatFraction(double numerator_, double denominator_){
+    if( denominator_ == 0 ){ return "-"; }
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(1) << 100.*numerator_/denominator_ << "%";
+    return ss.str();
+  }
+}
+
+void DialProfiler::Counters::add(const Counters& other_){
+  nbEvaluations += other_.nbEvaluations;
+  nbSkipped += other_.nbSkipped;
+  nanoseconds += other_.nanoseconds;
+  nbCacheHits += other_.nbCacheHits;
+  nbCacheMisses += other_.nbCacheMisses;
+}
+
+void DialProfiler::clear(){
+  _nbCalls_ = 0;
+  _collectionList_.clear();
+  _entryList_.clear();
+  _threadCounterList_.clear();
+}
+size_t DialProfiler::addCollection( const std::string& title_, size_t memoryFootprint_ ){
+  _collectionList_.emplace_back();
+  _collectionList_.back().title = title_;
+  _collectionList_.back().memoryFootprint = memoryFootprint_;
+  return _collectionList_.size() - 1;
+}
+size_t DialProfiler::addEntry( size_t collectionIndex_, const std::string& dialTypeName_ ){
+  _entryList_.emplace_back();
+  _entryList_.back().collectionIndex = collectionIndex_;
+  _entryList_.back().dialTypeName = dialTypeName_;
+  return _entryList_.size() - 1;
+}
+void DialProfiler::resetCounters( int nbThreads_ ){
+  _nbCalls_ = 0;
+  _threadCounterList_.clear();
+  _threadCounterList_.resize( std::max(nbThreads_, 1), std::vector<Counters>(_entryList_.size()) );
+}
+
+std::string DialProfiler::getSummary() const {
+  // merge the thread slots
+  std::vector<Counters> entryCounterList(_entryList_.size());
+  for( auto& threadCounters : _threadCounterList_ ){
+    for( size_t iEntry = 0 ; iEntry < entryCounterList.size() ; iEntry++ ){ entryCounterList[iEntry].add( threadCounters[iEntry] ); }
+  }
+
+  std::vector<Counters> collectionCounterList(_collectionList_.size());
+  std::vector<size_t> collectionNbDialsList(_collectionList_.size(), 0);
+  std::vector<std::string> collectionTypesList(_collectionList_.size());
+  std::map<std::string, Counters> typeCounterMap{};
+  std::map<std::string, size_t> typeNbDialsMap{};
+  uint64_t totalNanoseconds{0};
+  for( size_t iEntry = 0 ; iEntry < _entryList_.size() ; iEntry++ ){
+    auto& entry = _entryList_[iEntry];
+    collectionCounterList[entry.collectionIndex].add( entryCounterList[iEntry] );
+    collectionNbDialsList[entry.collectionIndex] += entry.nbDials;
+    if( not collectionTypesList[entry.collectionIndex].empty() ){ collectionTypesList[entry.collectionIndex] += "/"; }
+    collectionTypesList[entry.collectionIndex] += entry.dialTypeName;
+    typeCounterMap[entry.dialTypeName].add( entryCounterList[iEntry] );
+    typeNbDialsMap[entry.dialTypeName] += entry.nbDials;
+    totalNanoseconds += entryCounterList[iEntry].nanoseconds;
+  }
+
+  const double nbCalls{double(std::max(_nbCalls_, size_t(1)))};
+  auto fillLine = [&](GenericToolbox::TablePrinter& t_, size_t nbDials_, const Counters& counters_){
+    t_ << nbDials_ << GenericToolbox::TablePrinter::NextColumn;
+    t_ << double(counters_.nbEvaluations)/nbCalls << GenericToolbox::TablePrinter::NextColumn;
+    t_ << formatTime(double(counters_.nanoseconds)/nbCalls) << GenericToolbox::TablePrinter::NextColumn;
+    t_ << formatFraction(double(counters_.nanoseconds), double(totalNanoseconds)) << GenericToolbox::TablePrinter::NextColumn;
+    t_ << formatFraction(double(counters_.nbCacheHits), double(counters_.nbCacheHits + counters_.nbCacheMisses));
+  };
+
+  std::stringstream ss;
+  ss << "Dial evaluation profile over " << _nbCalls_ << " reweight calls ("
+     << formatTime(double(totalNanoseconds)/nbCalls) << " per call summed over the threads):" << std::endl;
+
+  // the most expensive collections first
+  std::vector<size_t> order(_collectionList_.size());
+  std::iota( order.begin(), order.end(), 0 );
+  std::stable_sort( order.begin(), order.end(), [&](size_t a_, size_t b_){
+    return collectionCounterList[a_].nanoseconds > collectionCounterList[b_].nanoseconds;
+  } );
+
+  GenericToolbox::TablePrinter t;
+  t << "Dial collection" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Dial types" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Nb dials" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Evaluated / call" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Time / call" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Time share" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Cache hits" << GenericToolbox::TablePrinter::NextColumn;
+  t << "Memory" << GenericToolbox::TablePrinter::NextLine;
+  for( auto iCollection : order ){
+    t << _collectionList_[iCollection].title << GenericToolbox::TablePrinter::NextColumn;
+    t << collectionTypesList[iCollection] << GenericToolbox::TablePrinter::NextColumn;
+    fillLine( t, collectionNbDialsList[iCollection], collectionCounterList[iCollection] );
+    t << GenericToolbox::TablePrinter::NextColumn;
+    t << GenericToolbox::parseSizeUnits(double(_collectionList_[iCollection].memoryFootprint)) << GenericToolbox::TablePrinter::NextLine;
+  }
+  ss << t.generateTableString() << std::endl;
+
+  GenericToolbox::TablePrinter tType;
+  tType << "Dial type" << GenericToolbox::TablePrinter::NextColumn;
+  tType << "Nb dials" << GenericToolbox::TablePrinter::NextColumn;
+  tType << "Evaluated / call" << GenericToolbox::TablePrinter::NextColumn;
+  tType << "Time / call" << GenericToolbox::TablePrinter::NextColumn;
+  tType << "Time share" << GenericToolbox::TablePrinter::NextColumn;
+  tType << "Cache hits" << GenericToolbox::TablePrinter::NextLine;
+  for( auto& typeCounters : typeCounterMap ){
+    tType << typeCounters.first << GenericToolbox::TablePrinter::NextColumn;
+    fillLine( tType, typeNbDialsMap[typeCounters.first], typeCounters.second );
+    tType << GenericToolbox::TablePrinter::NextLine;
+  }
+  ss << tType.generateTableString();
+
+  return ss.str();
+}
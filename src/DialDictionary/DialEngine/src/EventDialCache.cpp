@@ -4,12 +4,202 @@
 
 #include "EventDialCache.h"
 
+#include "GundamUtils.h"
+
+#include "Norm.h"
+#include "Shift.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "GeneralSpline.h"
+#include "MonotonicSpline.h"
+#include "LightGraph.h"
+#include "Polynomial.h"
+
+#include "GenericToolbox.Utils.h"
 #include "Logger.h"
 
+#include <map>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <typeinfo>
+#include <unordered_map>
+
 LoggerInit([]{
   Logger::setUserHeaderStr("[EventDialCache]");
 });
 
+namespace {
+  // identifies the dial interfaces giving the same response
+  struct DialInterfaceKey{
+    const DialBase* dialBase;
+    const DialInputBuffer* inputBuffer;
+    const DialResponseSupervisor* supervisor;
+    bool operator==(const DialInterfaceKey& other_) const {
+      return dialBase == other_.dialBase and inputBuffer == other_.inputBuffer and supervisor == other_.supervisor;
+    }
+  };
+  struct DialInterfaceKeyHash{
+    size_t operator()(const DialInterfaceKey& key_) const {
+      size_t hash{std::hash<const void*>{}(key_.dialBase)};
+      hash ^= std::hash<const void*>{}(key_.inputBuffer) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+      hash ^= std::hash<const void*>{}(key_.supervisor) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+      return hash;
+    }
+  };
+
+  // qualified call: no virtual dispatch, and inlined for the simple dials
+  template<typename T> struct DialEvaluator{
+    static double eval(const DialBase* dialBase_, const DialInputBuffer& input_){
+      return static_cast<const T*>(dialBase_)->T::evalResponse(input_);
+    }
+  };
+  template<> struct DialEvaluator<DialBase>{
+    static double eval(const DialBase* dialBase_, const DialInputBuffer& input_){
+      return dialBase_->evalResponse(input_);
+    }
+  };
+}
+
+EventDialCache::DialType EventDialCache::getDialType( const DialBase* dialBase_ ){
+  // exact type match: the derived (cached) dials keep their virtual evaluation
+  const std::type_info& t{typeid(*dialBase_)};
+  if( t == typeid(Norm) ){ return DialType::Norm; }
+  if( t == typeid(Shift) ){ return DialType::Shift; }
+  if( t == typeid(CompactSpline) ){ return DialType::CompactSpline; }
+  if( t == typeid(UniformSpline) ){ return DialType::UniformSpline; }
+  if( t == typeid(GeneralSpline) ){ return DialType::GeneralSpline; }
+  if( t == typeid(MonotonicSpline) ){ return DialType::MonotonicSpline; }
+  if( t == typeid(LightGraph) ){ return DialType::LightGraph; }
+  if( t == typeid(Polynomial) ){ return DialType::Polynomial; }
+  return DialType::Other;
+}
+float EventDialCache::getDialTypeCost( DialType dialType_ ){
+  switch( dialType_ ){
+    case DialType::Norm:
+    case DialType::Shift:
+      return 1;
+    case DialType::CompactSpline:
+    case DialType::UniformSpline:
+    case DialType::LightGraph:
+    case DialType::Polynomial:
+      return 3;
+    case DialType::GeneralSpline:
+    case DialType::MonotonicSpline:
+      // binary search of the knot
+      return 5;
+    default:
+      // virtual call, possibly through a cache
+      return 10;
+  }
+}
+template<typename T> void EventDialCache::updateDialResponseRange( size_t begin_, size_t end_ ){
+  for( size_t iDial = begin_ ; iDial < end_ ; iDial++ ){
+    auto* dialInterface = _dialInterfaceRefList_[iDial];
+    auto* inputBuffer = dialInterface->getInputBufferRef();
+
+    // evaluate the dial only if an update has been requested
+    // or if it has never been evaluated since the cache has been built
+    if( not inputBuffer->isDialUpdateRequested() and this->isDialResponseSet(iDial) ){ continue; }
+
+    // same as DialInterface::evalResponse()
+    if( inputBuffer->isMasked() ){ this->setDialResponse(iDial, 1); continue; }
+    this->setDialResponse(
+        iDial,
+        dialInterface->getResponseSupervisorRef()->process(
+            DialEvaluator<T>::eval( dialInterface->getDialBaseRef(), *inputBuffer )
+        )
+    );
+  }
+}
+void EventDialCache::updateSplineBatchRange( const DialTypeSegment& segment_, size_t begin_, size_t end_ ){
+  auto& splineBatch = _splineBatchList_[segment_.splineBatchIndex];
+  auto* inputBuffer = splineBatch.getInputBufferRef();
+
+  // the dials of a batch are always evaluated together
+  if( not inputBuffer->isDialUpdateRequested() and this->isDialResponseSet(begin_) ){ return; }
+
+  if( inputBuffer->isMasked() ){
+    for( size_t iDial = begin_ ; iDial < end_ ; iDial++ ){ this->setDialResponse(iDial, 1); }
+    return;
+  }
+
+  if( not _enableMixedPrecision_ ){
+    splineBatch.eval( begin_ - segment_.beginIndex, end_ - segment_.beginIndex, &_dialResponseList_[begin_] );
+    return;
+  }
+
+  // go through a small double buffer before rounding to float
+  const size_t blockSize{256};
+  double responseBuffer[blockSize];
+  for( size_t iBlock = begin_ ; iBlock < end_ ; iBlock += blockSize ){
+    size_t blockEnd{std::min(iBlock + blockSize, end_)};
+    splineBatch.eval( iBlock - segment_.beginIndex, blockEnd - segment_.beginIndex, responseBuffer );
+    for( size_t iDial = iBlock ; iDial < blockEnd ; iDial++ ){
+      _dialResponseFloatList_[iDial] = float(responseBuffer[iDial - iBlock]);
+    }
+  }
+}
+void EventDialCache::buildSplineBatches(){
+  _splineBatchList_.clear();
+
+  std::vector<DialTypeSegment> segmentList;
+  segmentList.reserve(_dialTypeSegmentList_.size());
+  size_t nBatchedDials{0};
+
+  for( auto& segment : _dialTypeSegmentList_ ){
+    if( segment.dialType != DialType::UniformSpline and segment.dialType != DialType::CompactSpline ){
+      segmentList.emplace_back( segment );
+      continue;
+    }
+
+    size_t iRunBegin{segment.beginIndex};
+    while( iRunBegin < segment.endIndex ){
+      auto& first = *_dialInterfaceRefList_[iRunBegin];
+      size_t iRunEnd{iRunBegin + 1};
+      if( SplineBatch::isBatchable(first) ){
+        while( iRunEnd < segment.endIndex and SplineBatch::isSameBatch(first, *_dialInterfaceRefList_[iRunEnd]) ){ iRunEnd++; }
+      }
+
+      if( iRunEnd - iRunBegin >= _splineBatchMinSize_ ){
+        _splineBatchList_.emplace_back();
+        _splineBatchList_.back().build( &_dialInterfaceRefList_[iRunBegin], iRunEnd - iRunBegin, _enableMixedPrecision_ );
+        nBatchedDials += iRunEnd - iRunBegin;
+
+        segmentList.emplace_back();
+        segmentList.back().dialType = segment.dialType;
+        segmentList.back().beginIndex = iRunBegin;
+        segmentList.back().endIndex = iRunEnd;
+        segmentList.back().splineBatchIndex = int(_splineBatchList_.size()) - 1;
+      }
+      else if( not segmentList.empty()
+               and segmentList.back().splineBatchIndex == -1
+               and segmentList.back().dialType == segment.dialType
+               and segmentList.back().endIndex == iRunBegin ){
+        // extend the regular range
+        segmentList.back().endIndex = iRunEnd;
+      }
+      else{
+        segmentList.emplace_back();
+        segmentList.back().dialType = segment.dialType;
+        segmentList.back().beginIndex = iRunBegin;
+        segmentList.back().endIndex = iRunEnd;
+      }
+
+      iRunBegin = iRunEnd;
+    }
+  }
+
+  _dialTypeSegmentList_ = std::move( segmentList );
+  _splineBatchList_.shrink_to_fit();
+
+  LogInfo << "Spline batches: " << _splineBatchList_.size() << " batches holding " << nBatchedDials
+          << " dials, evaluated with " << SplineBatch::getInstructionSetName() << " instructions." << std::endl;
+}
+
+
 void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<DialCollection>& dialCollectionList_){
   LogInfo << "Building event dial cache..." << std::endl;
 
@@ -44,10 +234,13 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
       iSample++;
 
       auto p = GenericToolbox::getSortPermutation(
-          sample.getMcContainer().getEventList(), []( const Event& a, const Event& b) {
-            if( a.getIndices().dataset < a.getIndices().dataset ){ return true; }
-            if( a.getIndices().entry < b.getIndices().entry ){ return true; }
-            return false;
+          sample.getMcContainer().getEventList(), [this]( const Event& a, const Event& b) {
+            // optionally make the events of each bin contiguous in memory
+            if( _sortEventsByBin_ and a.getIndices().bin != b.getIndices().bin ){
+              return a.getIndices().bin < b.getIndices().bin;
+            }
+            if( a.getIndices().dataset != b.getIndices().dataset ){ return a.getIndices().dataset < b.getIndices().dataset; }
+            return a.getIndices().entry < b.getIndices().entry;
           });
 
       LogThrowIf(
@@ -78,35 +271,201 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
       });
   };
 
-  LogInfo << "Filling up the " << nCacheSlots << " cache dial with references..." << std::endl;
-  _cache_.reserve( nCacheSlots );
+  LogInfo << "Flattening the dial interfaces for the response list..." << std::endl;
+  // the flat index of a dial interface is its position in the collection
+  // shifted by the number of interfaces of the previous collections.
+  // flatToResponseList[flatIndex] is the entry of the response list. Within a
+  // collection with interned dials, the interfaces sharing the same dial, input
+  // buffer and supervisor have the same response: they get a single entry.
+  std::vector<size_t> collectionOffsetList(dialCollectionList_.size(), 0);
+  std::vector<size_t> flatToResponseList{};
+  std::vector<size_t> collectionIndexList{};
+  _dialInterfaceRefList_.clear();
+  for( size_t iCollection = 0 ; iCollection < dialCollectionList_.size() ; iCollection++ ){
+    auto& dialCollection = dialCollectionList_[iCollection];
+    collectionOffsetList[iCollection] = flatToResponseList.size();
 
+    std::unordered_map<DialInterfaceKey, size_t, DialInterfaceKeyHash> responseIndexMap{};
+    for( auto& dialInterface : dialCollection.getDialInterfaceList() ){
+      if( dialCollection.isInternIdenticalDials() ){
+        auto entry = responseIndexMap.emplace(
+            DialInterfaceKey{dialInterface.getDialBaseRef(), dialInterface.getInputBufferRef(), dialInterface.getResponseSupervisorRef()},
+            _dialInterfaceRefList_.size()
+        );
+        flatToResponseList.emplace_back( entry.first->second );
+        if( not entry.second ){ continue; }
+      }
+      else{
+        flatToResponseList.emplace_back( _dialInterfaceRefList_.size() );
+      }
+      _dialInterfaceRefList_.emplace_back( &dialInterface );
+      collectionIndexList.emplace_back( iCollection );
+    }
+  }
+  _dialInterfaceRefList_.shrink_to_fit();
+  if( flatToResponseList.size() != _dialInterfaceRefList_.size() ){
+    LogInfo << "Shared dials: " << flatToResponseList.size() << " dial interfaces use "
+            << _dialInterfaceRefList_.size() << " response entries." << std::endl;
+  }
+
+  // group the dials by concrete type, keeping the collection order within a
+  // type. dialIndexRemap[i] is the new position of the i-th response entry.
+  std::vector<size_t> dialIndexRemap(_dialInterfaceRefList_.size(), 0);
+  {
+    std::vector<DialType> dialTypeList(_dialInterfaceRefList_.size());
+    for( size_t iDial = 0 ; iDial < _dialInterfaceRefList_.size() ; iDial++ ){
+      dialTypeList[iDial] = getDialType( _dialInterfaceRefList_[iDial]->getDialBaseRef() );
+    }
+
+    // with the spline batches, the splines of a collection are also grouped
+    // by knot grid so the batches are as long as possible
+    auto isGroupedByGrid = [&](size_t iDial_){
+      return _enableSplineBatches_
+             and ( dialTypeList[iDial_] == DialType::UniformSpline or dialTypeList[iDial_] == DialType::CompactSpline )
+             and _dialInterfaceRefList_[iDial_]->getDialBaseRef()->getDialData().size() >= 2;
+    };
+
+    std::vector<size_t> order(_dialInterfaceRefList_.size());
+    std::iota( order.begin(), order.end(), 0 );
+    std::stable_sort( order.begin(), order.end(), [&](size_t a_, size_t b_){
+      if( dialTypeList[a_] != dialTypeList[b_] ){ return dialTypeList[a_] < dialTypeList[b_]; }
+      if( not isGroupedByGrid(a_) or not isGroupedByGrid(b_) ){ return false; }
+      if( collectionIndexList[a_] != collectionIndexList[b_] ){ return collectionIndexList[a_] < collectionIndexList[b_]; }
+      auto& dataA = _dialInterfaceRefList_[a_]->getDialBaseRef()->getDialData();
+      auto& dataB = _dialInterfaceRefList_[b_]->getDialBaseRef()->getDialData();
+      if( dataA.size() != dataB.size() ){ return dataA.size() < dataB.size(); }
+      if( dataA[0] != dataB[0] ){ return dataA[0] < dataB[0]; }
+      return dataA[1] < dataB[1];
+    } );
+
+    std::vector<DialInterface*> sortedList(_dialInterfaceRefList_.size());
+    std::vector<size_t> sortedCollectionIndexList(_dialInterfaceRefList_.size());
+    _dialTypeSegmentList_.clear();
+    for( size_t iNew = 0 ; iNew < order.size() ; iNew++ ){
+      sortedList[iNew] = _dialInterfaceRefList_[order[iNew]];
+      sortedCollectionIndexList[iNew] = collectionIndexList[order[iNew]];
+      dialIndexRemap[order[iNew]] = iNew;
+
+      if( _dialTypeSegmentList_.empty() or _dialTypeSegmentList_.back().dialType != dialTypeList[order[iNew]] ){
+        _dialTypeSegmentList_.emplace_back();
+        _dialTypeSegmentList_.back().dialType = dialTypeList[order[iNew]];
+        _dialTypeSegmentList_.back().beginIndex = iNew;
+      }
+      _dialTypeSegmentList_.back().endIndex = iNew + 1;
+    }
+    _dialInterfaceRefList_ = std::move( sortedList );
+    collectionIndexList = std::move( sortedCollectionIndexList );
+  }
+  if( _enableSplineBatches_ ){ this->buildSplineBatches(); }
+  _dialProfileEntryList_.clear();
+  if( _dialProfiler_.isEnabled() ){ this->buildDialProfile( dialCollectionList_, collectionIndexList ); }
+  _dialProfileEntryList_.shrink_to_fit();
+  _dialResponseList_.clear();
+  _dialResponseFloatList_.clear();
+  if( not _enableMixedPrecision_ ){ _dialResponseList_.resize( _dialInterfaceRefList_.size(), std::nan("unset") ); }
+  else{ _dialResponseFloatList_.resize( _dialInterfaceRefList_.size(), std::nanf("unset") ); }
+  _dialResponseList_.shrink_to_fit();
+  _dialResponseFloatList_.shrink_to_fit();
+  LogInfo << "Nb of dial interfaces referenced: " << _dialInterfaceRefList_.size() << std::endl;
+
+  LogThrowIf( _dialInterfaceRefList_.size() > size_t(std::numeric_limits<DialIndex>::max()),
+              "Too many dial interfaces to be indexed: " << _dialInterfaceRefList_.size() );
+
+  size_t nDialLinks{0};
+  for( auto& sampleIndexCache : sampleIndexCacheList ){
+    for( auto& indexCache : sampleIndexCache ){ nDialLinks += countValidDials(indexCache.dials); }
+  }
+
+  LogInfo << "Filling up the " << nCacheSlots << " cache events with " << nDialLinks << " dial references..." << std::endl;
+  _eventRefList_.clear();
+  _eventRefList_.reserve( nCacheSlots );
+  _dialOffsetList_.clear();
+  _dialOffsetList_.reserve( nCacheSlots + 1 );
+  _dialIndexList_.clear();
+  _dialIndexList_.reserve( nDialLinks );
+
+  _dialOffsetList_.emplace_back( 0 );
   for( auto& sampleIndexCache : sampleIndexCacheList ){
     for( auto& indexCache : sampleIndexCache ){
-      
-      _cache_.emplace_back();
-      auto& cacheEntry = _cache_.back();
 
-      cacheEntry.event =
+      _eventRefList_.emplace_back(
           &sampleSet_.getSampleList().at(
               indexCache.event.sampleIndex
           ).getMcContainer().getEventList().at(
               indexCache.event.eventIndex
-          );
-
-      // make sure we don't need extra allocation while emplace_back
-      cacheEntry.dialResponseCacheList.reserve( countValidDials(indexCache.dials) );
+          )
+      );
 
       // filling up the dial references
       for( auto& dialIndex : indexCache.dials ){
         if( dialIndex.collectionIndex == size_t(-1) or dialIndex.interfaceIndex == size_t(-1) ){ continue; }
-        cacheEntry.dialResponseCacheList.emplace_back(
-            dialCollectionList_.at(dialIndex.collectionIndex)
-            .getDialInterfaceList().at(dialIndex.interfaceIndex)
+        _dialIndexList_.emplace_back(
+            DialIndex( dialIndexRemap[flatToResponseList[collectionOffsetList[dialIndex.collectionIndex] + dialIndex.interfaceIndex]] )
         );
       }
+      _dialOffsetList_.emplace_back( _dialIndexList_.size() );
+    }
+  }
+
+  LogThrowIf( _eventRefList_.size() > size_t(std::numeric_limits<EventIndex>::max()),
+              "Too many events to be indexed: " << _eventRefList_.size() );
+
+  LogInfo << "Balancing the thread slices on the number of dials per event..." << std::endl;
+  _eventDispenser_.nEntries = _eventRefList_.size();
+  _eventDispenser_.threadBoundList = GundamUtils::getCostBalancedBounds(
+      _eventRefList_.size(), GundamGlobals::getParallelWorker().getNbThreads(),
+      // resetting the event weight costs about as much as a dial
+      [this](size_t iEvent_){ return double(_dialOffsetList_[iEvent_] + iEvent_); }
+  );
+  _dialDispenser_.nEntries = _dialInterfaceRefList_.size();
+  _dialDispenser_.threadBoundList.clear();
+
+  if( _enableIncrementalReweight_ ){ this->buildInvertedIndex(); }
+  _isFullReweightRequested_ = true;
+
+  _dialLinkResponseList_.clear();
+  if( not _enableTwoPhaseReweight_ ){
+    _dialLinkResponseList_.resize( _dialIndexList_.size(), std::nan("unset") );
+  }
+  _dialLinkResponseList_.shrink_to_fit();
+
+  LogInfo << "Event dial cache memory footprint: " << GenericToolbox::parseSizeUnits(double(
+      _eventRefList_.size() * sizeof(Event*)
+      + _dialOffsetList_.size() * sizeof(size_t)
+      + _dialIndexList_.size() * sizeof(DialIndex)
+      + _dialLinkResponseList_.size() * sizeof(double)
+      + _dialInterfaceRefList_.size() * sizeof(DialInterface*)
+      + _dialResponseList_.size() * sizeof(double)
+      + _dialResponseFloatList_.size() * sizeof(float)
+      + _bufferDialIndexList_.size() * sizeof(DialIndex)
+      + _bufferEventIndexList_.size() * sizeof(EventIndex)
+      + _dialProfileEntryList_.size() * sizeof(uint32_t)
+  )) << std::endl;
+}
+void EventDialCache::buildDialProfile( std::vector<DialCollection>& dialCollectionList_, const std::vector<size_t>& dialCollectionIndexList_ ){
+  LogInfo << "Defining the dial profile entries..." << std::endl;
+
+  _dialProfiler_.clear();
+  for( auto& dialCollection : dialCollectionList_ ){
+    _dialProfiler_.addCollection( dialCollection.getTitle(), dialCollection.getMemoryFootprint() );
+  }
+
+  // one entry per collection and dial type name
+  std::map<std::pair<size_t, std::string>, uint32_t> entryIndexMap{};
+  _dialProfileEntryList_.resize( _dialInterfaceRefList_.size() );
+  for( size_t iDial = 0 ; iDial < _dialInterfaceRefList_.size() ; iDial++ ){
+    auto key = std::make_pair( dialCollectionIndexList_[iDial], _dialInterfaceRefList_[iDial]->getDialBaseRef()->getDialTypeName() );
+    auto entryIt = entryIndexMap.find( key );
+    if( entryIt == entryIndexMap.end() ){
+      entryIt = entryIndexMap.emplace( key, uint32_t(_dialProfiler_.addEntry(key.first, key.second)) ).first;
     }
+    _dialProfileEntryList_[iDial] = entryIt->second;
+    _dialProfiler_.getEntry( entryIt->second ).nbDials++;
   }
+
+  _dialProfiler_.resetCounters( GundamGlobals::getParallelWorker().getNbThreads() );
+  LogInfo << "Dial profile: " << _dialProfiler_.getNbEntries() << " entries for "
+          << dialCollectionList_.size() << " dial collections." << std::endl;
 }
 void EventDialCache::allocateCacheEntries( size_t nEvent_, size_t nDialsMaxPerEvent_) {
     _indexedCache_.resize(
@@ -127,19 +486,318 @@ EventDialCache::IndexedCacheEntry* EventDialCache::fetchNextCacheEntry(){
 }
 
 
-void EventDialCache::reweightEntry( EventDialCache::CacheEntry& entry_){
+void EventDialCache::reweightEntry( size_t iEvent_ ){
   // storing the reweight factor in a temporary buffer
   // this allows to perform capping of the value
   double tempReweight{1};
 
-  // calculate the dial responses
-  for( auto& dialResponseCache : entry_.dialResponseCacheList ){
-    tempReweight *= dialResponseCache.getResponse();
+  const size_t dialBegin{_dialOffsetList_[iEvent_]};
+  const size_t dialEnd{_dialOffsetList_[iEvent_+1]};
+
+  if( _enableTwoPhaseReweight_ and _enableMixedPrecision_ ){
+    // responses are stored as float, but the product is done in double
+    for( size_t iLink = dialBegin ; iLink < dialEnd ; iLink++ ){
+      tempReweight *= double( _dialResponseFloatList_[_dialIndexList_[iLink]] );
+    }
+  }
+  else if( _enableTwoPhaseReweight_ ){
+    // the responses are already evaluated: only gather and multiply
+    for( size_t iLink = dialBegin ; iLink < dialEnd ; iLink++ ){
+      tempReweight *= _dialResponseList_[_dialIndexList_[iLink]];
+    }
+  }
+  else{
+    // calculate the dial responses
+    for( size_t iLink = dialBegin ; iLink < dialEnd ; iLink++ ){
+      auto* dialInterface = _dialInterfaceRefList_[_dialIndexList_[iLink]];
+      // evaluate the dial if an update has been requested
+      if( dialInterface->getInputBufferRef()->isDialUpdateRequested() or std::isnan(_dialLinkResponseList_[iLink]) ){
+        _dialLinkResponseList_[iLink] = dialInterface->evalResponse();
+      }
+      tempReweight *= _dialLinkResponseList_[iLink];
+    }
   }
 
   // applying event weight cap if defined
   _globalEventReweightCap_.process( tempReweight );
 
-  entry_.event->getWeights().resetCurrentWeight(); // reset to the base weight
-  entry_.event->getWeights().current *= tempReweight; // apply the reweight factor
+  _eventRefList_[iEvent_]->getWeights().resetCurrentWeight(); // reset to the base weight
+  _eventRefList_[iEvent_]->getWeights().current *= tempReweight; // apply the reweight factor
+}
+void EventDialCache::updateDialResponses( int iThread_ ){
+  size_t begin, end;
+  int iFetch{0};
+  while( _dialDispenser_.fetch(iThread_, iFetch++, begin, end) ){
+    // split the fetched range along the dial type segments
+    auto segmentIt = std::upper_bound(
+        _dialTypeSegmentList_.begin(), _dialTypeSegmentList_.end(), begin,
+        [](size_t index_, const DialTypeSegment& segment_){ return index_ < segment_.endIndex; }
+    );
+    for( ; segmentIt != _dialTypeSegmentList_.end() and segmentIt->beginIndex < end ; ++segmentIt ){
+      auto& segment = *segmentIt;
+      size_t segBegin{std::max(begin, segment.beginIndex)};
+      size_t segEnd{std::min(end, segment.endIndex)};
+      if( segBegin >= segEnd ){ continue; }
+
+      if( this->isDialProfilingActive() ){ this->updateProfiledSegmentRange(iThread_, segment, segBegin, segEnd); }
+      else{ this->updateSegmentRange(segment, segBegin, segEnd); }
+    }
+  }
+}
+void EventDialCache::updateSegmentRange( const DialTypeSegment& segment_, size_t begin_, size_t end_ ){
+  if( segment_.splineBatchIndex != -1 ){
+    this->updateSplineBatchRange(segment_, begin_, end_);
+    return;
+  }
+
+  switch( segment_.dialType ){
+    case DialType::Norm:            this->updateDialResponseRange<Norm>(begin_, end_); break;
+    case DialType::Shift:           this->updateDialResponseRange<Shift>(begin_, end_); break;
+    case DialType::CompactSpline:   this->updateDialResponseRange<CompactSpline>(begin_, end_); break;
+    case DialType::UniformSpline:   this->updateDialResponseRange<UniformSpline>(begin_, end_); break;
+    case DialType::GeneralSpline:   this->updateDialResponseRange<GeneralSpline>(begin_, end_); break;
+    case DialType::MonotonicSpline: this->updateDialResponseRange<MonotonicSpline>(begin_, end_); break;
+    case DialType::LightGraph:      this->updateDialResponseRange<LightGraph>(begin_, end_); break;
+    case DialType::Polynomial:      this->updateDialResponseRange<Polynomial>(begin_, end_); break;
+    default:                        this->updateDialResponseRange<DialBase>(begin_, end_); break;
+  }
+}
+void EventDialCache::updateProfiledSegmentRange( int iThread_, const DialTypeSegment& segment_, size_t begin_, size_t end_ ){
+  // the dials of an entry are contiguous in the flat list, so the range
+  // splits in a few runs
+  size_t runBegin{begin_};
+  while( runBegin < end_ ){
+    const auto iEntry{_dialProfileEntryList_[runBegin]};
+    size_t runEnd{runBegin + 1};
+    while( runEnd < end_ and _dialProfileEntryList_[runEnd] == iEntry ){ runEnd++; }
+
+    auto& counters = _dialProfiler_.getCounters(iThread_, iEntry);
+    for( size_t iDial = runBegin ; iDial < runEnd ; iDial++ ){
+      auto* inputBuffer = _dialInterfaceRefList_[iDial]->getInputBufferRef();
+      if( inputBuffer->isMasked() or ( not inputBuffer->isDialUpdateRequested() and this->isDialResponseSet(iDial) ) ){
+        counters.nbSkipped++;
+      }
+      else{ counters.nbEvaluations++; }
+    }
+
+    DialProfiler::Scope scope(&counters);
+    auto start = std::chrono::steady_clock::now();
+    this->updateSegmentRange(segment_, runBegin, runEnd);
+    counters.nanoseconds += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count());
+
+    runBegin = runEnd;
+  }
+}
+bool EventDialCache::prepareIncrementalReweight(){
+  // the incremental mode relies on the flat response list
+  if( not _enableIncrementalReweight_ or not _enableTwoPhaseReweight_ ){ return false; }
+
+  if( _isFullReweightRequested_ ){
+    // the caller will perform a full reweight
+    _isFullReweightRequested_ = false;
+    return false;
+  }
+
+  // first check how many events would be touched
+  const auto nEventsMax{size_t(_incrementalReweightMaxFraction_ * double(_eventRefList_.size()))};
+  size_t nTouchedEvents{0};
+  for( size_t iBuffer = 0 ; iBuffer < _inputBufferRefList_.size() ; iBuffer++ ){
+    if( not _inputBufferRefList_[iBuffer]->isDialUpdateRequested() ){ continue; }
+    nTouchedEvents += _bufferEventOffsetList_[iBuffer+1] - _bufferEventOffsetList_[iBuffer];
+    if( nTouchedEvents > nEventsMax ){ return false; }
+  }
+
+  _dirtyDialList_.clear();
+  _dirtyEventList_.clear();
+  for( size_t iBuffer = 0 ; iBuffer < _inputBufferRefList_.size() ; iBuffer++ ){
+    if( not _inputBufferRefList_[iBuffer]->isDialUpdateRequested() ){ continue; }
+
+    _dirtyDialList_.insert(
+        _dirtyDialList_.end(),
+        _bufferDialIndexList_.begin() + long(_bufferDialOffsetList_[iBuffer]),
+        _bufferDialIndexList_.begin() + long(_bufferDialOffsetList_[iBuffer+1])
+    );
+
+    // an event can depend on several of the updated inputs
+    for( size_t iEntry = _bufferEventOffsetList_[iBuffer] ; iEntry < _bufferEventOffsetList_[iBuffer+1] ; iEntry++ ){
+      auto iEvent = _bufferEventIndexList_[iEntry];
+      if( _isEventDirtyList_[iEvent] ){ continue; }
+      _isEventDirtyList_[iEvent] = true;
+      _dirtyEventList_.emplace_back( iEvent );
+    }
+  }
+
+  // keep the memory access in order while reweighting
+  std::sort( _dirtyEventList_.begin(), _dirtyEventList_.end() );
+  for( auto& iEvent : _dirtyEventList_ ){ _isEventDirtyList_[iEvent] = false; }
+
+  // the dial types and the number of dials per event vary a lot: split the
+  // dirty lists between the threads on their cost rather than their length
+  const int nThreads{GundamGlobals::getParallelWorker().getNbThreads()};
+  auto getCumulativeCost = [this](size_t iEntry_){ return _dirtyCostList_[iEntry_]; };
+
+  _dirtyCostList_.resize( _dirtyDialList_.size() + 1 );
+  _dirtyCostList_[0] = 0;
+  for( size_t iEntry = 0 ; iEntry < _dirtyDialList_.size() ; iEntry++ ){
+    _dirtyCostList_[iEntry+1] = _dirtyCostList_[iEntry] + _dialCostList_[_dirtyDialList_[iEntry]];
+  }
+  _dirtyDialBoundList_ = GundamUtils::getCostBalancedBounds( _dirtyDialList_.size(), nThreads, getCumulativeCost );
+
+  _dirtyCostList_.resize( _dirtyEventList_.size() + 1 );
+  for( size_t iEntry = 0 ; iEntry < _dirtyEventList_.size() ; iEntry++ ){
+    auto iEvent = _dirtyEventList_[iEntry];
+    _dirtyCostList_[iEntry+1] = _dirtyCostList_[iEntry] + double(_dialOffsetList_[iEvent+1] - _dialOffsetList_[iEvent] + 1);
+  }
+  _dirtyEventBoundList_ = GundamUtils::getCostBalancedBounds( _dirtyEventList_.size(), nThreads, getCumulativeCost );
+
+  return true;
+}
+void EventDialCache::updateDirtyDialResponses( int iThread_ ){
+  size_t beginIndex{0};
+  size_t endIndex{_dirtyDialList_.size()};
+  if( iThread_ == -1 ){ iThread_ = 0; }
+  else{
+    beginIndex = _dirtyDialBoundList_[iThread_];
+    endIndex = _dirtyDialBoundList_[iThread_+1];
+  }
+
+  auto evalDirtyDials = [this](size_t begin_, size_t end_){
+    for( size_t iEntry = begin_ ; iEntry < end_ ; iEntry++ ){
+      auto iDial = _dirtyDialList_[iEntry];
+      this->setDialResponse( iDial, _dialInterfaceRefList_[iDial]->evalResponse() );
+    }
+  };
+
+  if( not this->isDialProfilingActive() ){
+    evalDirtyDials(beginIndex, endIndex);
+    return;
+  }
+
+  // the dirty dials are listed per input buffer: the runs of the same
+  // profile entry are long
+  size_t runBegin{beginIndex};
+  while( runBegin < endIndex ){
+    const auto iEntry{_dialProfileEntryList_[_dirtyDialList_[runBegin]]};
+    size_t runEnd{runBegin + 1};
+    while( runEnd < endIndex and _dialProfileEntryList_[_dirtyDialList_[runEnd]] == iEntry ){ runEnd++; }
+
+    auto& counters = _dialProfiler_.getCounters(iThread_, iEntry);
+    counters.nbEvaluations += uint64_t(runEnd - runBegin);
+
+    DialProfiler::Scope scope(&counters);
+    auto start = std::chrono::steady_clock::now();
+    evalDirtyDials(runBegin, runEnd);
+    counters.nanoseconds += uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start
+    ).count());
+
+    runBegin = runEnd;
+  }
+}
+void EventDialCache::reweightDirtyEntries( int iThread_ ){
+  size_t beginIndex{0};
+  size_t endIndex{_dirtyEventList_.size()};
+  if( iThread_ != -1 ){
+    beginIndex = _dirtyEventBoundList_[iThread_];
+    endIndex = _dirtyEventBoundList_[iThread_+1];
+  }
+
+  for( size_t iEntry = beginIndex ; iEntry < endIndex ; iEntry++ ){
+    this->reweightEntry( _dirtyEventList_[iEntry] );
+  }
+}
+void EventDialCache::buildInvertedIndex(){
+  LogInfo << "Building the inverted index from the dial inputs to the events..." << std::endl;
+  std::vector<size_t> dialBufferIndexList(_dialInterfaceRefList_.size(), 0);
+  {
+    std::unordered_map<const DialInputBuffer*, size_t> bufferIndexMap;
+    _inputBufferRefList_.clear();
+    for( size_t iDial = 0 ; iDial < _dialInterfaceRefList_.size() ; iDial++ ){
+      auto* inputBuffer = _dialInterfaceRefList_[iDial]->getInputBufferRef();
+      auto it = bufferIndexMap.find( inputBuffer );
+      if( it == bufferIndexMap.end() ){
+        it = bufferIndexMap.emplace( inputBuffer, _inputBufferRefList_.size() ).first;
+        _inputBufferRefList_.emplace_back( inputBuffer );
+      }
+      dialBufferIndexList[iDial] = it->second;
+    }
+  }
+
+  // counting sort of the dials and the events per input buffer
+  _bufferDialOffsetList_.clear();
+  _bufferDialOffsetList_.resize( _inputBufferRefList_.size() + 1, 0 );
+  _bufferEventOffsetList_.clear();
+  _bufferEventOffsetList_.resize( _inputBufferRefList_.size() + 1, 0 );
+  for( auto& bufferIndex : dialBufferIndexList ){ _bufferDialOffsetList_[bufferIndex+1]++; }
+  for( auto& dialIndex : _dialIndexList_ ){ _bufferEventOffsetList_[dialBufferIndexList[dialIndex]+1]++; }
+  for( size_t iBuffer = 0 ; iBuffer < _inputBufferRefList_.size() ; iBuffer++ ){
+    _bufferDialOffsetList_[iBuffer+1] += _bufferDialOffsetList_[iBuffer];
+    _bufferEventOffsetList_[iBuffer+1] += _bufferEventOffsetList_[iBuffer];
+  }
+
+  _bufferDialIndexList_.clear();
+  _bufferDialIndexList_.resize( _dialInterfaceRefList_.size() );
+  _bufferEventIndexList_.clear();
+  _bufferEventIndexList_.resize( _dialIndexList_.size() );
+  {
+    std::vector<size_t> fillIndexList( _bufferDialOffsetList_.begin(), _bufferDialOffsetList_.end() - 1 );
+    for( size_t iDial = 0 ; iDial < dialBufferIndexList.size() ; iDial++ ){
+      _bufferDialIndexList_[fillIndexList[dialBufferIndexList[iDial]]++] = DialIndex( iDial );
+    }
+    fillIndexList.assign( _bufferEventOffsetList_.begin(), _bufferEventOffsetList_.end() - 1 );
+    for( size_t iEvent = 0 ; iEvent < _eventRefList_.size() ; iEvent++ ){
+      for( size_t iLink = _dialOffsetList_[iEvent] ; iLink < _dialOffsetList_[iEvent+1] ; iLink++ ){
+        _bufferEventIndexList_[fillIndexList[dialBufferIndexList[_dialIndexList_[iLink]]]++] = EventIndex( iEvent );
+      }
+    }
+  }
+
+  _dialCostList_.clear();
+  _dialCostList_.resize( _dialInterfaceRefList_.size(), 0 );
+  for( auto& segment : _dialTypeSegmentList_ ){
+    std::fill(
+        _dialCostList_.begin() + long(segment.beginIndex), _dialCostList_.begin() + long(segment.endIndex),
+        getDialTypeCost( segment.dialType )
+    );
+  }
+
+  _dirtyDialList_.clear();
+  _dirtyEventList_.clear();
+  _isEventDirtyList_.clear();
+  _isEventDirtyList_.resize( _eventRefList_.size(), false );
+}
+bool EventDialCache::WorkDispenser::fetch( int iThread_, int iFetch_, size_t& begin_, size_t& end_ ){
+  if( chunkSize == 0 ){
+    // static: only one slice per thread
+    if( iFetch_ != 0 ){ return false; }
+
+    int nThreads{GundamGlobals::getParallelWorker().getNbThreads()};
+    if( iThread_ == -1 ){ begin_ = 0; end_ = nEntries; }
+    else if( threadBoundList.size() == size_t(nThreads + 1) ){
+      begin_ = threadBoundList[iThread_];
+      end_ = threadBoundList[iThread_ + 1];
+    }
+    else{
+      auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(iThread_, nThreads, int(nEntries));
+      begin_ = size_t(bounds.beginIndex);
+      end_ = size_t(bounds.endIndex);
+    }
+    return begin_ < end_;
+  }
+
+  // dynamic: grab the next chunk
+  begin_ = (nextChunk++) * chunkSize;
+  if( begin_ >= nEntries ){ return false; }
+  end_ = std::min(begin_ + chunkSize, nEntries);
+  return true;
+}
+double EventDialCache::evalEntryReweight( size_t iEvent_ ) const{
+  double tempReweight{1};
+  for( size_t iLink = _dialOffsetList_[iEvent_] ; iLink < _dialOffsetList_[iEvent_+1] ; iLink++ ){
+    tempReweight *= _dialInterfaceRefList_[_dialIndexList_[iLink]]->evalResponse();
+  }
+  _globalEventReweightCap_.process( tempReweight );
+  return tempReweight;
 }
@@ -0,0 +1,287 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "SplineBatch.h"
+
+#include "UniformSpline.h"
+#include "CompactSpline.h"
+
+#include "Logger.h"
+
+#include <typeinfo>
+#include <algorithm>
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[SplineBatch]");
+});
+
+// Compile the batched loops for several instruction sets. The dynamic loader
+// picks the best one supported by the CPU (GNU ifunc), so only ELF targets.
+#if defined(__x86_64__) && defined(__linux__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define SPLINE_BATCH_TARGET_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#endif
+#endif
+#ifndef SPLINE_BATCH_TARGET_CLONES
+#define SPLINE_BATCH_TARGET_CLONES
+#endif
+
+namespace {
+
+  // Same clamping as CalculateUniformSpline/CalculateCompactSpline (+-1E20)
+  // followed by the response supervisor. Written as selects to vectorize.
+  inline double clampResponse(double v_, double min_, double max_){
+    v_ = (v_ < -1E20) ? -1E20 : v_;
+    v_ = (v_ > 1E20) ? 1E20 : v_;
+    v_ = (v_ < min_) ? min_ : v_;
+    v_ = (v_ > max_) ? max_ : v_;
+    return v_;
+  }
+
+  // Hermite cubic of CalculateUniformSpline for all the dials. The slopes
+  // still have to be scaled by the step. The knot data (T) is double, or
+  // float in mixed precision mode: the cubic is always done in double.
+  template<typename T> inline void uniformSplineLoop(
+      size_t n_, double fx_, double step_,
+      const T* __restrict p1_, const T* __restrict m1_,
+      const T* __restrict p2_, const T* __restrict m2_,
+      double min_, double max_, double* __restrict out_){
+    for( size_t i = 0 ; i < n_ ; i++ ){
+      const double p1 = p1_[i];
+      const double p2 = p2_[i];
+      const double m1 = double(m1_[i])*step_;
+      const double m2 = double(m2_[i])*step_;
+      const double v = ((((2.0*p1 - 2.0*p2 + m2 + m1)*fx_
+                          + 3.0*p2 - 3.0*p1 - m2 - 2.0*m1)*fx_
+                         + m1)*fx_
+                        + p1);
+      out_[i] = clampResponse(v, min_, max_);
+    }
+  }
+
+  // Catmull-Rom cubic of CalculateCompactSpline for all the dials. The knot
+  // rows are the two points used for each of the three deltas.
+  template<typename T> inline void compactSplineLoop(
+      size_t n_, double fx_,
+      const T* __restrict d21a_, const T* __restrict d21b_,
+      const T* __restrict p2_, const T* __restrict p3_,
+      const T* __restrict d43a_, const T* __restrict d43b_,
+      double min_, double max_, double* __restrict out_){
+    for( size_t i = 0 ; i < n_ ; i++ ){
+      const double p2 = p2_[i];
+      const double p3 = p3_[i];
+      const double d21 = double(d21b_[i]) - double(d21a_[i]);
+      const double d32 = p3 - p2;
+      const double d43 = double(d43b_[i]) - double(d43a_[i]);
+      const double m2 = 0.5*(d21+d32);
+      const double m3 = 0.5*(d32+d43);
+      const double v = ((((2.0*p2 - 2.0*p3 + m3 + m2)*fx_
+                          + 3.0*p3 - 3.0*p2 - m3 - 2.0*m2)*fx_
+                         + m2)*fx_
+                        + p2);
+      out_[i] = clampResponse(v, min_, max_);
+    }
+  }
+
+  // One set of clones per knot data type (target_clones can't be put on a
+  // template).
+  SPLINE_BATCH_TARGET_CLONES
+  void evalUniformSplineLoop(
+      size_t n_, double fx_, double step_,
+      const double* p1_, const double* m1_, const double* p2_, const double* m2_,
+      double min_, double max_, double* out_){
+    uniformSplineLoop(n_, fx_, step_, p1_, m1_, p2_, m2_, min_, max_, out_);
+  }
+  SPLINE_BATCH_TARGET_CLONES
+  void evalUniformSplineLoop(
+      size_t n_, double fx_, double step_,
+      const float* p1_, const float* m1_, const float* p2_, const float* m2_,
+      double min_, double max_, double* out_){
+    uniformSplineLoop(n_, fx_, step_, p1_, m1_, p2_, m2_, min_, max_, out_);
+  }
+  SPLINE_BATCH_TARGET_CLONES
+  void evalCompactSplineLoop(
+      size_t n_, double fx_,
+      const double* d21a_, const double* d21b_, const double* p2_, const double* p3_,
+      const double* d43a_, const double* d43b_,
+      double min_, double max_, double* out_){
+    compactSplineLoop(n_, fx_, d21a_, d21b_, p2_, p3_, d43a_, d43b_, min_, max_, out_);
+  }
+  SPLINE_BATCH_TARGET_CLONES
+  void evalCompactSplineLoop(
+      size_t n_, double fx_,
+      const float* d21a_, const float* d21b_, const float* p2_, const float* p3_,
+      const float* d43a_, const float* d43b_,
+      double min_, double max_, double* out_){
+    compactSplineLoop(n_, fx_, d21a_, d21b_, p2_, p3_, d43a_, d43b_, min_, max_, out_);
+  }
+
+}
+
+bool SplineBatch::isBatchable( const DialInterface& dialInterface_ ){
+  // exact type: the cached dials must keep their own evaluation
+  const std::type_info& t{typeid(*dialInterface_.getDialBaseRef())};
+  if( t != typeid(UniformSpline) and t != typeid(CompactSpline) ){ return false; }
+  if( dialInterface_.getInputBufferRef() == nullptr ){ return false; }
+  if( dialInterface_.getInputBufferRef()->getBufferSize() != 1 ){ return false; }
+  return true;
+}
+bool SplineBatch::isSameBatch( const DialInterface& a_, const DialInterface& b_ ){
+  if( a_.getInputBufferRef() != b_.getInputBufferRef() ){ return false; }
+  if( a_.getResponseSupervisorRef() != b_.getResponseSupervisorRef() ){ return false; }
+
+  auto* dialA = a_.getDialBaseRef();
+  auto* dialB = b_.getDialBaseRef();
+  if( typeid(*dialA) != typeid(*dialB) ){ return false; }
+  if( dialA->getAllowExtrapolation() != dialB->getAllowExtrapolation() ){ return false; }
+
+  // same knot grid
+  auto& dataA = dialA->getDialData();
+  auto& dataB = dialB->getDialData();
+  if( dataA.size() != dataB.size() or dataA.size() < 2 ){ return false; }
+  if( dataA[0] != dataB[0] or dataA[1] != dataB[1] ){ return false; }
+
+  if( typeid(*dialA) == typeid(UniformSpline) ){
+    return static_cast<const UniformSpline*>(dialA)->getSplineBounds() == static_cast<const UniformSpline*>(dialB)->getSplineBounds();
+  }
+  return static_cast<const CompactSpline*>(dialA)->getSplineBounds() == static_cast<const CompactSpline*>(dialB)->getSplineBounds();
+}
+std::string SplineBatch::getInstructionSetName(){
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+  __builtin_cpu_init();
+  if( __builtin_cpu_supports("avx512f") ){ return "avx512f"; }
+  if( __builtin_cpu_supports("avx2") ){ return "avx2"; }
+#endif
+  return "scalar";
+}
+
+void SplineBatch::build( DialInterface* const* dialInterfaceList_, size_t nDials_, bool useFloat_ ){
+  LogThrowIf(nDials_ == 0, "Empty spline batch.");
+  auto& first = *dialInterfaceList_[0];
+  LogThrowIf(not isBatchable(first), "Dial can't be batched: " << first.getSummary());
+
+  auto* dialBase = first.getDialBaseRef();
+  auto& data = dialBase->getDialData();
+
+  _nbDials_ = nDials_;
+  _inputBufferRef_ = first.getInputBufferRef();
+  _lowerBound_ = data[0];
+  _step_ = data[1];
+  _allowExtrapolation_ = dialBase->getAllowExtrapolation();
+
+  if( typeid(*dialBase) == typeid(UniformSpline) ){
+    _splineType_ = SplineType::UniformSpline;
+    _splineBounds_ = static_cast<const UniformSpline*>(dialBase)->getSplineBounds();
+    _nbKnots_ = int(data.size()-2)/2;
+  }
+  else{
+    _splineType_ = SplineType::CompactSpline;
+    _splineBounds_ = static_cast<const CompactSpline*>(dialBase)->getSplineBounds();
+    _nbKnots_ = int(data.size()-2);
+  }
+
+  _minResponse_ = -INFINITY;
+  _maxResponse_ = INFINITY;
+  if( first.getResponseSupervisorRef() != nullptr ){
+    auto* supervisor = first.getResponseSupervisorRef();
+    if( not std::isnan(supervisor->getMinResponse()) ){ _minResponse_ = supervisor->getMinResponse(); }
+    if( not std::isnan(supervisor->getMaxResponse()) ){ _maxResponse_ = supervisor->getMaxResponse(); }
+  }
+
+  // transpose the knot data
+  _valueList_.assign(size_t(_nbKnots_) * _nbDials_, 0);
+  _slopeList_.clear();
+  if( _splineType_ == SplineType::UniformSpline ){ _slopeList_.assign(size_t(_nbKnots_) * _nbDials_, 0); }
+
+  for( size_t iDial = 0 ; iDial < _nbDials_ ; iDial++ ){
+    LogThrowIf(not isSameBatch(first, *dialInterfaceList_[iDial]), "Dial doesn't belong to the batch: " << dialInterfaceList_[iDial]->getSummary());
+    auto& dialData = dialInterfaceList_[iDial]->getDialBaseRef()->getDialData();
+    for( int iKnot = 0 ; iKnot < _nbKnots_ ; iKnot++ ){
+      if( _splineType_ == SplineType::UniformSpline ){
+        _valueList_[iKnot*_nbDials_ + iDial] = dialData[2 + 2*iKnot + 0];
+        _slopeList_[iKnot*_nbDials_ + iDial] = dialData[2 + 2*iKnot + 1];
+      }
+      else{
+        _valueList_[iKnot*_nbDials_ + iDial] = dialData[2 + iKnot];
+      }
+    }
+  }
+  _useFloat_ = useFloat_;
+  _valueFloatList_.clear();
+  _slopeFloatList_.clear();
+  if( _useFloat_ ){
+    _valueFloatList_.assign(_valueList_.begin(), _valueList_.end());
+    _slopeFloatList_.assign(_slopeList_.begin(), _slopeList_.end());
+    std::vector<double>().swap(_valueList_);
+    std::vector<double>().swap(_slopeList_);
+  }
+}
+void SplineBatch::eval( size_t begin_, size_t end_, double* responseList_ ) const{
+  if( begin_ >= end_ ){ return; }
+  const size_t n{end_ - begin_};
+
+  double dialInput{_inputBufferRef_->getInputBuffer()[0]};
+  if( not _allowExtrapolation_ ){
+    if     (dialInput <= _splineBounds_.first) { dialInput = _splineBounds_.first; }
+    else if(dialInput >= _splineBounds_.second){ dialInput = _splineBounds_.second; }
+  }
+
+  // the segment and the position in the segment are the same for all the
+  // dials, follows CalculateUniformSpline/CalculateCompactSpline
+  const double xx = (dialInput - _lowerBound_)/_step_;
+  auto row = [&](const auto& list_, int iKnot_){
+    return list_.data() + size_t(iKnot_)*_nbDials_ + begin_;
+  };
+
+  if( _splineType_ == SplineType::UniformSpline ){
+    const int dim{2 + 2*_nbKnots_};
+    int ix = int(xx);
+    if( ix < 0 ) ix = 0;
+    if( 2*ix+7 > dim ) ix = (dim-2)/2 - 2;
+    const double fx = xx - ix;
+
+    if( _useFloat_ ){
+      evalUniformSplineLoop(
+          n, fx, _step_,
+          row(_valueFloatList_, ix), row(_slopeFloatList_, ix),
+          row(_valueFloatList_, ix+1), row(_slopeFloatList_, ix+1),
+          _minResponse_, _maxResponse_, responseList_
+      );
+      return;
+    }
+    evalUniformSplineLoop(
+        n, fx, _step_,
+        row(_valueList_, ix), row(_slopeList_, ix),
+        row(_valueList_, ix+1), row(_slopeList_, ix+1),
+        _minResponse_, _maxResponse_, responseList_
+    );
+  }
+  else{
+    const int dim{_nbKnots_};
+    const int ix = (xx<0) ? int(xx-1) : int(xx);
+    auto clampIndex = [&](int i_){ return std::min(std::max(i_, 0), dim-2); };
+    const int d21 = clampIndex(ix-1);
+    const int d32 = clampIndex(ix);
+    const int d43 = clampIndex(ix+1);
+    const double fx = xx - d32;
+
+    if( _useFloat_ ){
+      evalCompactSplineLoop(
+          n, fx,
+          row(_valueFloatList_, d21), row(_valueFloatList_, d21+1),
+          row(_valueFloatList_, d32), row(_valueFloatList_, d32+1),
+          row(_valueFloatList_, d43), row(_valueFloatList_, d43+1),
+          _minResponse_, _maxResponse_, responseList_
+      );
+      return;
+    }
+    evalCompactSplineLoop(
+        n, fx,
+        row(_valueList_, d21), row(_valueList_, d21+1),
+        row(_valueList_, d32), row(_valueList_, d32+1),
+        row(_valueList_, d43), row(_valueList_, d43+1),
+        _minResponse_, _maxResponse_, responseList_
+    );
+  }
+}
@@ -36,6 +36,22 @@ public:
                      bool useCachedDial_);
 
   DialBase* makeDial(const JsonType& config_);
+
+  // Construct a dial interpolating the response of a dial with a single
+  // input, tabulated on a uniform grid over [min_, max_].  The
+  // interpolation is either "cubic" (CompactSpline) or "linear"
+  // (LightGraph).  The grid is refined until the difference with the
+  // original dial, checked between the grid points, is below maxError_.  If
+  // that takes more than nMaxPoints_ points, or if the response is not
+  // finite on the grid, this returns a nullptr and the original dial should
+  // be kept.  NOTE: The ownership of the pointer is
+  // passed to the caller.
+  DialBase* makeTabulatedDial(const DialBase& dial_,
+                              const DialInputBuffer& input_,
+                              double min_, double max_,
+                              const std::string& interpolation_,
+                              double maxError_,
+                              int nMaxPoints_);
 };
 
 //  A Lesser GNU Public License
@@ -0,0 +1,37 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef GUNDAM_FORMULA_COMPILER_H
+#define GUNDAM_FORMULA_COMPILER_H
+
+#include <string>
+
+
+// Translate the formula strings of the formula dials into C++, and compile
+// them with the system compiler into shared libraries that can be loaded by
+// CompiledLibDial.  The libraries are cached on disk, keyed by a hash of the
+// generated source, so each formula is only compiled once.
+//
+// The compiler is taken from the CXX environment variable (or "c++"), and the
+// cache directory from GUNDAM_FORMULA_CACHE (or "$XDG_CACHE_HOME/gundam/formulas",
+// "~/.cache/gundam/formulas").  The cache directory and the libraries are
+// only used if they are owned by the user and not writable by anyone else.
+namespace FormulaCompiler {
+
+  // Translate a TFormula expression of the inputs (x, y, z, t or x[i]) into
+  // a C++ expression of the double array "x".  Only the arithmetic and
+  // comparison operators, numbers and the usual math functions are
+  // supported.  Returns false if the formula uses anything else.
+  bool translateFormula(const std::string& formula_, std::string& cppExpression_);
+
+  // Return the path of the shared library defining
+  //   extern "C" double evalVariable(double* x)
+  // for the formula, compiling it if it's not in the cache.  Returns an empty
+  // string if the formula can't be translated or compiled.
+  std::string getCompiledFormula(const std::string& formula_);
+
+}
+
+
+#endif //GUNDAM_FORMULA_COMPILER_H
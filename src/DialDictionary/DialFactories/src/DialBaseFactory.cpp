@@ -2,12 +2,20 @@
 #include "NormDialBaseFactory.h"
 #include "GraphDialBaseFactory.h"
 #include "SplineDialBaseFactory.h"
+#include "GridDialBaseFactory.h"
 
 #include "RootFormula.h"
 #include "CompiledLibDial.h"
+#include "FormulaCompiler.h"
+#include "CompactSpline.h"
+#include "LightGraph.h"
 
 #include "Logger.h"
 
+#include <TGraph.h>
+
+#include <cmath>
+
 LoggerInit([]{
   Logger::setUserHeaderStr("[DialBaseFactory]");
 });
@@ -37,6 +45,10 @@ DialBase* DialBaseFactory::makeDial(const std::string& dialTitle_,
     SplineDialBaseFactory factory;
     dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
   }
+  else if (dialType_ == "Grid") {
+    GridDialBaseFactory factory;
+    dialBase.reset(factory.makeDial(dialTitle_, dialType_, dialSubType_, dialInitializer_, useCachedDial_));
+  }
 #define INCLUDE_DEPRECATED_DIAL_TYPES
 #ifdef INCLUDE_DEPRECATED_DIAL_TYPES
   else if (dialType_ == "MonotonicSpline") {
@@ -83,12 +95,31 @@ DialBase* DialBaseFactory::makeDial(const JsonType& config_){
   dialType = GenericToolbox::Json::fetchValue(config_, {{"dialType"}, {"dialsType"}}, dialType);
 
   if( dialType == "Formula" or dialType == "RootFormula" ){
-    dialBase = std::make_unique<RootFormula>();
-    auto* rootFormulaPtr{(RootFormula*) dialBase.get()};
-
     auto formulaConfig{GenericToolbox::Json::fetchValue<JsonType>(config_, "dialConfig")};
+    auto formulaStr{GenericToolbox::Json::fetchValue<std::string>(formulaConfig, "formulaStr")};
+
+    // native code for the formula (opt-in), TFormula is kept as a fallback
+    if( GenericToolbox::Json::fetchValue(formulaConfig, "compileFormula", false) ){
+      auto libraryPath{FormulaCompiler::getCompiledFormula(formulaStr)};
+      if( not libraryPath.empty() ){
+        auto compiledLibDial{std::make_unique<CompiledLibDial>()};
+        if( compiledLibDial->loadLibrary( libraryPath ) ){ dialBase = std::move(compiledLibDial); }
+      }
+      if( dialBase == nullptr ){ LogAlert << "Using TFormula for: " << formulaStr << std::endl; }
+    }
 
-    rootFormulaPtr->setFormulaStr( GenericToolbox::Json::fetchValue<std::string>(formulaConfig, "formulaStr") );
+    if( dialBase == nullptr ){
+      dialBase = std::make_unique<RootFormula>();
+      auto* rootFormulaPtr{(RootFormula*) dialBase.get()};
+      rootFormulaPtr->setFormulaStr( formulaStr );
+    }
+  }
+  else if( dialType == "Grid" ){
+    auto gridConfig{GenericToolbox::Json::fetchValue<JsonType>(config_, "dialConfig")};
+    auto dialSubType{GenericToolbox::Json::fetchValue(config_, "dialSubType", std::string())};
+
+    GridDialBaseFactory factory;
+    dialBase.reset(factory.makeDial("Grid", dialSubType, gridConfig));
   }
   else if( dialType == "CompiledLibDial" ){
     dialBase = std::make_unique<CompiledLibDial>();
@@ -106,6 +137,74 @@ DialBase* DialBaseFactory::makeDial(const JsonType& config_){
   return dialBase.release();
 }
 
+DialBase* DialBaseFactory::makeTabulatedDial(const DialBase& dial_,
+                                             const DialInputBuffer& input_,
+                                             double min_, double max_,
+                                             const std::string& interpolation_,
+                                             double maxError_,
+                                             int nMaxPoints_) {
+  LogThrowIf(input_.getBufferSize() != 1, "Only dials with a single input can be tabulated.");
+  LogThrowIf(not std::isfinite(min_) or not std::isfinite(max_) or not (min_ < max_),
+             "Invalid tabulation range: [" << min_ << ", " << max_ << "]");
+  LogThrowIf(interpolation_ != "cubic" and interpolation_ != "linear",
+             "Unknown tabulation interpolation: " << interpolation_);
+
+  // The dial is evaluated with a private copy of the input buffer.
+  DialInputBuffer input{input_};
+  auto evalDial = [&](const DialBase& dialRef_, double x_){
+    input.getInputBuffer()[0] = x_;
+    return dialRef_.evalResponse(input);
+  };
+
+  std::unique_ptr<DialBase> dialBase;
+  std::vector<double> xPoints;
+  std::vector<double> yPoints;
+  std::vector<double> dummy;
+
+  // Start with 16 segments, and double them until the error is met.
+  for (int nSegments = 16; nSegments+1 <= nMaxPoints_; nSegments *= 2) {
+    const double step = (max_-min_)/nSegments;
+    xPoints.resize(nSegments+1);
+    yPoints.resize(nSegments+1);
+    for (int i = 0; i <= nSegments; ++i) {
+      xPoints[i] = (i < nSegments) ? min_ + i*step : max_;
+      yPoints[i] = evalDial(dial_, xPoints[i]);
+      if( not std::isfinite(yPoints[i]) ){
+        LogDebug << "Can't tabulate " << dial_.getDialTypeName() << ": invalid response "
+                 << yPoints[i] << " at " << xPoints[i] << std::endl;
+        return nullptr;
+      }
+    }
+
+    if (interpolation_ == "cubic") {
+      dialBase = std::make_unique<CompactSpline>();
+      dialBase->buildDial(xPoints, yPoints, dummy);
+    }
+    else {
+      dialBase = std::make_unique<LightGraph>();
+      dialBase->buildDial(TGraph(int(xPoints.size()), xPoints.data(), yPoints.data()));
+    }
+
+    // Check at the quarters of each segment where the interpolation is the
+    // least constrained.
+    double maxError = 0.0;
+    for (int i = 0; i < nSegments and maxError <= maxError_; ++i) {
+      for (double f : {0.25, 0.5, 0.75}) {
+        const double x = xPoints[i] + f*step;
+        maxError = std::max(maxError, std::abs(evalDial(*dialBase, x) - evalDial(dial_, x)));
+      }
+    }
+    if (maxError <= maxError_) {
+      dialBase->setAllowExtrapolation(false);
+      return dialBase.release();
+    }
+  }
+
+  LogAlert << "Could not tabulate " << dial_.getDialTypeName() << " within "
+           << maxError_ << " with " << nMaxPoints_ << " points." << std::endl;
+  return nullptr;
+}
+
 
 //  A Lesser GNU Public License
 
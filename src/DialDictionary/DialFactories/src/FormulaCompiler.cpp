@@ -0,0 +1,269 @@
+//
+// Created on 17/10/2026.
+//
+
+#include "FormulaCompiler.h"
+
+#include "GenericToolbox.Json.h"
+#include "Logger.h"
+
+#include <map>
+#include <mutex>
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/stat.h>
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[FormulaCompiler]");
+});
+
+namespace {
+
+  // TFormula functions and their C++ equivalent. The fabs/fmin/fmax
+  // versions avoid the integer overloads.
+  const std::map<std::string, std::string> functionTranslation{
+      {"sin", "std::sin"}, {"cos", "std::cos"}, {"tan", "std::tan"},
+      {"asin", "std::asin"}, {"acos", "std::acos"}, {"atan", "std::atan"}, {"atan2", "std::atan2"},
+      {"sinh", "std::sinh"}, {"cosh", "std::cosh"}, {"tanh", "std::tanh"},
+      {"exp", "std::exp"}, {"log", "std::log"}, {"log10", "std::log10"},
+      {"sqrt", "std::sqrt"}, {"pow", "std::pow"}, {"abs", "std::fabs"}, {"fabs", "std::fabs"},
+      {"min", "std::fmin"}, {"max", "std::fmax"},
+      {"TMath::Sin", "std::sin"}, {"TMath::Cos", "std::cos"}, {"TMath::Tan", "std::tan"},
+      {"TMath::Exp", "std::exp"}, {"TMath::Log", "std::log"}, {"TMath::Log10", "std::log10"},
+      {"TMath::Sqrt", "std::sqrt"}, {"TMath::Power", "std::pow"}, {"TMath::Abs", "std::fabs"},
+      {"TMath::Min", "std::fmin"}, {"TMath::Max", "std::fmax"}, {"TMath::Erf", "std::erf"},
+      {"TMath::Pi", "gundamPi"}
+  };
+  const std::map<std::string, int> variableIndex{ {"x", 0}, {"y", 1}, {"z", 2}, {"t", 3} };
+
+  // FNV-1a, only used to name the cached libraries
+  uint64_t hashString(const std::string& str_){
+    uint64_t out{14695981039346656037ULL};
+    for( unsigned char c : str_ ){ out ^= c; out *= 1099511628211ULL; }
+    return out;
+  }
+
+  // The libraries are loaded into the process, so they are kept in a
+  // per-user directory and never taken from a location other users can
+  // write to.
+  std::string getCacheDirectory(){
+    if( getenv("GUNDAM_FORMULA_CACHE") != nullptr ){ return getenv("GUNDAM_FORMULA_CACHE"); }
+    if( getenv("XDG_CACHE_HOME") != nullptr and getenv("XDG_CACHE_HOME")[0] == '/' ){
+      return std::string(getenv("XDG_CACHE_HOME")) + "/gundam/formulas";
+    }
+    if( getenv("HOME") != nullptr and getenv("HOME")[0] == '/' ){
+      return std::string(getenv("HOME")) + "/.cache/gundam/formulas";
+    }
+    std::string tmpDir{getenv("TMPDIR") != nullptr ? getenv("TMPDIR") : "/tmp"};
+    return tmpDir + "/gundam-formulas-" + std::to_string(geteuid());
+  }
+
+  // true if the path is a directory (or a regular file) owned by the user,
+  // and not writable by the group or the others.  Symlinks are refused.
+  bool isTrustedPath(const std::string& path_, bool isDirectory_){
+    struct stat info{};
+    if( lstat(path_.c_str(), &info) != 0 ){ return false; }
+    if( isDirectory_ ? not S_ISDIR(info.st_mode) : not S_ISREG(info.st_mode) ){ return false; }
+    if( info.st_uid != geteuid() ){ return false; }
+    return (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+  }
+
+  // mkdir -p, creating the missing directories with mode 0700
+  bool makePrivateDirectory(const std::string& path_){
+    for( size_t pos{path_.find('/', 1)} ; ; pos = path_.find('/', pos+1) ){
+      const std::string subPath{path_.substr(0, pos)};
+      if( not subPath.empty() and mkdir(subPath.c_str(), S_IRWXU) != 0 and errno != EEXIST ){ return false; }
+      if( pos == std::string::npos ){ break; }
+    }
+    return isTrustedPath(path_, true);
+  }
+
+  std::mutex cacheMutex{};
+  std::map<std::string, std::string> compiledFormulaList{};
+
+}
+
+namespace FormulaCompiler {
+
+  bool translateFormula(const std::string& formula_, std::string& cppExpression_){
+    std::stringstream ss;
+    size_t i{0};
+    const size_t n{formula_.size()};
+
+    auto skipSpaces = [&](size_t pos_){
+      while( pos_ < n and std::isspace((unsigned char) formula_[pos_]) ){ pos_++; }
+      return pos_;
+    };
+
+    while( i < n ){
+      const char c{formula_[i]};
+
+      if( std::isspace((unsigned char) c) ){ ss << ' '; i++; continue; }
+
+      // numbers: keep the floating point division of TFormula
+      if( std::isdigit((unsigned char) c) or (c == '.' and i+1 < n and std::isdigit((unsigned char) formula_[i+1])) ){
+        size_t end{i};
+        bool isInteger{true};
+        while( end < n and std::isdigit((unsigned char) formula_[end]) ){ end++; }
+        if( end < n and formula_[end] == '.' ){
+          isInteger = false; end++;
+          while( end < n and std::isdigit((unsigned char) formula_[end]) ){ end++; }
+        }
+        if( end < n and (formula_[end] == 'e' or formula_[end] == 'E') ){
+          size_t expEnd{end+1};
+          if( expEnd < n and (formula_[expEnd] == '+' or formula_[expEnd] == '-') ){ expEnd++; }
+          if( expEnd < n and std::isdigit((unsigned char) formula_[expEnd]) ){
+            isInteger = false;
+            while( expEnd < n and std::isdigit((unsigned char) formula_[expEnd]) ){ expEnd++; }
+            end = expEnd;
+          }
+        }
+        // an identifier glued to a number ("2x") isn't a valid expression
+        if( end < n and (std::isalpha((unsigned char) formula_[end]) or formula_[end] == '_') ){ return false; }
+        ss << formula_.substr(i, end-i) << (isInteger ? ".0" : "");
+        i = end;
+        continue;
+      }
+
+      // identifiers, including the TMath:: namespace
+      if( std::isalpha((unsigned char) c) or c == '_' ){
+        size_t end{i};
+        while( end < n and (std::isalnum((unsigned char) formula_[end]) or formula_[end] == '_') ){ end++; }
+        std::string name{formula_.substr(i, end-i)};
+        if( name == "TMath" and formula_.compare(end, 2, "::") == 0 ){
+          size_t nameEnd{end+2};
+          while( nameEnd < n and (std::isalnum((unsigned char) formula_[nameEnd]) or formula_[nameEnd] == '_') ){ nameEnd++; }
+          name = formula_.substr(i, nameEnd-i);
+          end = nameEnd;
+        }
+        i = end;
+
+        size_t next{skipSpaces(i)};
+        if( functionTranslation.find(name) != functionTranslation.end() ){
+          if( next >= n or formula_[next] != '(' ){ return false; }
+          ss << functionTranslation.at(name);
+          continue;
+        }
+        if( name == "pi" ){ ss << "gundamPi()"; continue; }
+        if( variableIndex.find(name) == variableIndex.end() ){ return false; }
+
+        if( name == "x" and next < n and formula_[next] == '[' ){
+          // x[i] notation
+          size_t indexBegin{skipSpaces(next+1)};
+          size_t indexEnd{indexBegin};
+          while( indexEnd < n and std::isdigit((unsigned char) formula_[indexEnd]) ){ indexEnd++; }
+          size_t closing{skipSpaces(indexEnd)};
+          if( indexEnd == indexBegin or closing >= n or formula_[closing] != ']' ){ return false; }
+          ss << "x[" << formula_.substr(indexBegin, indexEnd-indexBegin) << "]";
+          i = closing+1;
+          continue;
+        }
+        ss << "x[" << variableIndex.at(name) << "]";
+        continue;
+      }
+
+      // two characters operators
+      if( i+1 < n ){
+        const std::string op{formula_.substr(i, 2)};
+        if( op == "==" or op == "!=" or op == "<=" or op == ">=" or op == "&&" or op == "||" ){
+          ss << op; i += 2; continue;
+        }
+      }
+
+      // '^' is a power in TFormula, '=', '&' and '|' would change meaning
+      if( std::string("+-*/(),<>!?:").find(c) == std::string::npos ){ return false; }
+      ss << c;
+      i++;
+    }
+
+    cppExpression_ = ss.str();
+    return not GenericToolbox::trimString(cppExpression_, " ").empty();
+  }
+
+  std::string getCompiledFormula(const std::string& formula_){
+    std::string cppExpression;
+    if( not translateFormula(formula_, cppExpression) ){
+      LogAlert << "Formula \"" << formula_ << "\" can't be translated to C++." << std::endl;
+      return {};
+    }
+
+    std::lock_guard<std::mutex> guard(cacheMutex);
+    if( compiledFormulaList.find(formula_) != compiledFormulaList.end() ){ return compiledFormulaList[formula_]; }
+
+    std::string compiler{getenv("CXX") != nullptr ? getenv("CXX") : "c++"};
+
+    std::stringstream src;
+    src << "// GUNDAM formula: " << GenericToolbox::replaceSubstringInString(formula_, "\n", " ") << std::endl;
+    src << "// compiler: " << compiler << std::endl;
+    src << "#include <cmath>" << std::endl;
+    src << "static inline double gundamPi(){ return 3.14159265358979323846; }" << std::endl;
+    src << "extern \"C\" double evalVariable(double* x){ return (" << cppExpression << "); }" << std::endl;
+
+    std::stringstream name;
+    name << "gundamFormula_" << std::hex << hashString(src.str());
+    const std::string cacheDir{getCacheDirectory()};
+    const std::string libPath{cacheDir + "/" + name.str() + ".so"};
+
+    if( not makePrivateDirectory(cacheDir) ){
+      LogAlert << "The formula cache " << cacheDir
+               << " can't be created, or isn't a directory owned by the user "
+               << "and only writable by them." << std::endl;
+      return {};
+    }
+
+    if( GenericToolbox::isFile(libPath) ){
+      if( not isTrustedPath(libPath, false) ){
+        LogAlert << "Ignoring " << libPath << ": it isn't a file owned by the user "
+                 << "and only writable by them." << std::endl;
+        return {};
+      }
+      compiledFormulaList[formula_] = libPath;
+      return libPath;
+    }
+
+    if( system(nullptr) == 0 ){
+      LogAlert << "No shell available to compile the formula \"" << formula_ << "\"." << std::endl;
+      return {};
+    }
+
+    // compile under temporary names, the rename makes it safe against
+    // concurrent jobs sharing the cache
+    std::stringstream tmpName;
+    tmpName << cacheDir << "/" << name.str() << "." << getpid();
+    const std::string srcPath{tmpName.str() + ".cpp"};
+    const std::string tmpLibPath{tmpName.str() + ".so"};
+
+    std::stringstream cmd;
+    {
+      std::ofstream srcFile(srcPath);
+      srcFile << src.str();
+      if( not srcFile.good() ){
+        LogAlert << "Could not write " << srcPath << std::endl;
+        return {};
+      }
+    }
+
+    LogInfo << "Compiling formula \"" << formula_ << "\" with " << compiler << std::endl;
+    cmd << compiler << " -O2 -fPIC -shared \"" << srcPath << "\" -o \"" << tmpLibPath << "\" > /dev/null 2>&1";
+    bool success{system(cmd.str().c_str()) == 0};
+    std::remove(srcPath.c_str());
+    // the compiler follows the umask, the cached library must not be writable by others
+    if( success ){ success = (chmod(tmpLibPath.c_str(), S_IRWXU) == 0); }
+    if( success ){ success = (std::rename(tmpLibPath.c_str(), libPath.c_str()) == 0); }
+    if( not success ){
+      std::remove(tmpLibPath.c_str());
+      LogAlert << "Could not compile the formula \"" << formula_ << "\": " << cmd.str() << std::endl;
+      return {};
+    }
+
+    compiledFormulaList[formula_] = libPath;
+    return libPath;
+  }
+
+}
@@ -0,0 +1,74 @@
+#include "GridDialBaseFactory.h"
+
+// Explicitly list the headers that are actually needed.  Do not include
+// others.
+#include "GridSpline.h"
+
+#include <TH1.h>
+
+LoggerInit([]{
+  Logger::setUserHeaderStr("[GridFactory]");
+});
+
+DialBase* GridDialBaseFactory::makeDial(const std::string& dialTitle_,
+                                        const std::string& dialType_,
+                                        const std::string& dialSubType_,
+                                        TObject* dialInitializer_,
+                                        bool useCachedDial_) {
+
+  TH1* srcHist = dynamic_cast<TH1*>(dialInitializer_);
+
+  LogThrowIf(srcHist == nullptr, "Grid dial initializer must be a TH1, TH2 or TH3");
+
+  // Stuff the created dial into a unique_ptr, so it will be properly deleted
+  // in the event of an exception.
+  std::unique_ptr<DialBase> dialBase;
+
+  dialBase = (useCachedDial_) ?
+    std::make_unique<GridSplineCache>():
+    std::make_unique<GridSpline>();
+
+  dialBase->buildDial(*srcHist, dialSubType_);
+
+  // Pass the ownership without any constraints!
+  return dialBase.release();
+}
+
+DialBase* GridDialBaseFactory::makeDial(const std::string& dialTitle_,
+                                        const std::string& dialSubType_,
+                                        const JsonType& dialConfig_) {
+  auto knotList = GenericToolbox::Json::fetchValue<std::vector<std::vector<double>>>(dialConfig_, "knots");
+  auto valueList = GenericToolbox::Json::fetchValue<std::vector<double>>(dialConfig_, "values");
+
+  auto dialBase = std::make_unique<GridSpline>();
+  dialBase->buildGrid(knotList, valueList, dialSubType_);
+
+  return dialBase.release();
+}
+
+//  A Lesser GNU Public License
+
+//  Copyright (C) 2023 GUNDAM DEVELOPERS
+
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the
+//
+//  Free Software Foundation, Inc.
+//  51 Franklin Street, Fifth Floor,
+//  Boston, MA  02110-1301  USA
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
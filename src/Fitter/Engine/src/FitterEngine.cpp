@@ -381,6 +381,16 @@ void FitterEngine::fit(){
   LogInfo << "Minimizing LLH..." << std::endl;
   this->_minimizer_->minimize();
 
+  if( _likelihoodInterface_.getDataSetManager().getPropagator().getEventDialCache().getDialProfiler().isEnabled() ){
+    LogWarning << "Dial collection profile:" << std::endl;
+    std::string dialProfile{_likelihoodInterface_.getDataSetManager().getPropagator().getDialProfileTableStr()};
+    LogInfo << dialProfile << std::endl;
+    GenericToolbox::writeInTFile(
+        GenericToolbox::mkdirTFile( _saveDir_, "postFit" ),
+        TNamed("dialProfile", dialProfile.c_str())
+    );
+  }
+
   LogWarning << "Saving post-fit par state..." << std::endl;
   _postFitParState_ = _likelihoodInterface_.getDataSetManager().getPropagator().getParametersManager().exportParameterInjectorConfig();
   GenericToolbox::writeInTFile(
@@ -11,6 +11,8 @@
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <cstdint>
 
 
 class ParameterSet;
@@ -65,6 +67,7 @@ public:
   [[nodiscard]] bool isEigen() const{ return _isEigen_; }
   [[nodiscard]] bool isEnabled() const{ return _isEnabled_; }
   [[nodiscard]] bool gotUpdated() const { return _gotUpdated_; }
+  [[nodiscard]] uint64_t getValueVersion() const{ return _valueVersion_; }
   [[nodiscard]] int getParameterIndex() const{ return _parameterIndex_; }
   [[nodiscard]] double getStepSize() const{ return _stepSize_; }
   [[nodiscard]] double getMinValue() const{ return _minValue_; }
@@ -83,7 +86,7 @@ public:
   [[nodiscard]] PriorType getPriorType() const{ return _priorType_; }
 
   // Core
-  void setValueAtPrior(){ _parameterValue_ = _priorValue_; }
+  void setValueAtPrior();
   void setCurrentValueAsPrior(){ _priorValue_ = _parameterValue_; }
   [[nodiscard]] bool isValueWithinBounds() const;
   [[nodiscard]] double getDistanceFromNominal() const; // in unit of sigmas
@@ -99,6 +102,7 @@ private:
   bool _isFree_{false};
   bool _gotUpdated_{false};
   int _parameterIndex_{-1}; // to get the right definition in the json config (in case "name" is not specified)
+  uint64_t _valueVersion_{0}; // renewed each time the parameter value changes
   double _parameterValue_{std::nan("unset")};
   double _priorValue_{std::nan("unset")};
   double _throwValue_{std::nan("unset")};
@@ -119,6 +123,10 @@ private:
   const ParameterSet* _owner_{nullptr};
   PriorType _priorType_{PriorType::Gaussian};
 
+  /// Versions are drawn from a shared counter so they stay unique even when
+  /// parameters are copied around (e.g. restoring a parameter set).
+  static std::atomic<uint64_t> _valueVersionCounter_;
+
 };
 
 
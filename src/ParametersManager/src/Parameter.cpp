@@ -13,6 +13,7 @@
 
 LoggerInit([]{ Logger::setUserHeaderStr("[Parameter]"); });
 
+std::atomic<uint64_t> Parameter::_valueVersionCounter_{0};
 
 void Parameter::readConfigImpl(){
   if( not _parameterConfig_.empty() ){
@@ -91,9 +92,15 @@ void Parameter::setParameterValue(double parameterValue) {
   if( _parameterValue_ != parameterValue ){
     _gotUpdated_ = true;
     _parameterValue_ = parameterValue;
+    _valueVersion_ = ++_valueVersionCounter_;
   }
   else{ _gotUpdated_ = false; }
 }
+void Parameter::setValueAtPrior(){
+  if( _parameterValue_ == _priorValue_ ){ return; }
+  _parameterValue_ = _priorValue_;
+  _valueVersion_ = ++_valueVersionCounter_;
+}
 void Parameter::setDialSetConfig(const JsonType &jsonConfig_) {
   auto jsonConfig = jsonConfig_;
   while( jsonConfig.is_string() ){
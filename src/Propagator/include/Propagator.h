@@ -45,6 +45,7 @@ public:
   [[nodiscard]] bool isShowEventBreakdown() const { return _showEventBreakdown_; }
   [[nodiscard]] bool isDebugPrintLoadedEvents() const { return _debugPrintLoadedEvents_; }
   [[nodiscard]] int getDebugPrintLoadedEventsNbPerSample() const { return _debugPrintLoadedEventsNbPerSample_; }
+  [[nodiscard]] const std::string& getCacheManagerIndexWidth() const { return _cacheManagerIndexWidth_; }
   [[nodiscard]] int getIThrow() const { return _iThrow_; }
   [[nodiscard]] const EventDialCache& getEventDialCache() const { return _eventDialCache_; }
   [[nodiscard]] const ParametersManager &getParametersManager() const { return _parManager_; }
@@ -69,6 +70,7 @@ public:
 
   // Misc
   [[nodiscard]] std::string getSampleBreakdownTableStr() const;
+  [[nodiscard]] std::string getDialProfileTableStr() const;
   void printBreakdowns();
 
   // Logger related
@@ -81,6 +83,16 @@ protected:
   // multithreading
   void reweightMcEvents(int iThread_);
   void refillMcHistogramsFct( int iThread_);
+  void refillDirtyMcHistogramsFct( int iThread_);
+  void reweightAndFillMcHistogramsFct( int iThread_);
+  void reduceMcHistogramsFct( int iThread_);
+
+  // fused reweight + histogram fill
+  void buildHistogramCellIndices();
+  void reweightAndRefillMcHistograms();
+
+  // compare the mixed precision weights with the double precision ones
+  void validateMixedPrecision() const;
 
 private:
   // Parameters
@@ -89,7 +101,11 @@ private:
   bool _debugPrintLoadedEvents_{false};
   bool _devSingleThreadReweight_{false};
   bool _devSingleThreadHistFill_{false};
+  bool _enableFusedReweightHistFill_{false};
+  bool _validateMixedPrecision_{false};
+  double _mixedPrecisionTolerance_{1E-5};
   int _debugPrintLoadedEventsNbPerSample_{5};
+  std::string _cacheManagerIndexWidth_{"int32"};
   JsonType _parameterInjectorMc_;
   JsonType _parameterInjectorToy_;
 
@@ -102,6 +118,17 @@ private:
   bool _enableEigenToOrigInPropagate_{true};
   int _iThrow_{-1};
 
+  // set if the events haven't been reweighted incrementally since the last refill
+  bool _isFullHistogramRefillRequested_{true};
+
+  // fused reweight + histogram fill: each event of the cache points to a
+  // global histogram cell (all the bins of all the samples one after the
+  // other), and each thread accumulates (w, w^2) in its own cell buffer
+  std::vector<int> _eventCellIndexList_{};
+  std::vector<std::pair<int, int>> _cellBinList_{}; // cell -> (sample, bin)
+  std::vector<size_t> _threadCellBoundList_{}; // cell ranges of the refill threads
+  std::vector<std::vector<double>> _threadCellBufferList_{};
+
   // Sub-layers
   SampleSet _sampleSet_{};
   PlotGenerator _plotGenerator_{};
@@ -11,6 +11,7 @@
 #include "ParameterSet.h"
 #include "GundamGlobals.h"
 #include "ConfigUtils.h"
+#include "GundamUtils.h"
 
 #include "GenericToolbox.Utils.h"
 #include "GenericToolbox.Json.h"
@@ -61,13 +62,47 @@ void Propagator::readConfigImpl(){
   _debugPrintLoadedEventsNbPerSample_ = GenericToolbox::Json::fetchValue(_config_, "debugPrintLoadedEventsNbPerSample", _debugPrintLoadedEventsNbPerSample_);
   _devSingleThreadReweight_ = GenericToolbox::Json::fetchValue(_config_, "devSingleThreadReweight", _devSingleThreadReweight_);
   _devSingleThreadHistFill_ = GenericToolbox::Json::fetchValue(_config_, "devSingleThreadHistFill", _devSingleThreadHistFill_);
+  _enableFusedReweightHistFill_ = GenericToolbox::Json::fetchValue(_config_, "enableFusedReweightHistFill", _enableFusedReweightHistFill_);
 
   // EventDialCache parameters
+  _eventDialCache_.setEnableTwoPhaseReweight(
+      GenericToolbox::Json::fetchValue(_config_, "enableTwoPhaseReweight", _eventDialCache_.isTwoPhaseReweightEnabled())
+  );
+  _eventDialCache_.setEnableMixedPrecision(
+      GenericToolbox::Json::fetchValue(_config_, "enableMixedPrecision", _eventDialCache_.isMixedPrecisionEnabled())
+  );
+  _validateMixedPrecision_ = GenericToolbox::Json::fetchValue(_config_, "validateMixedPrecision", _validateMixedPrecision_);
+  _eventDialCache_.setEnableSplineBatches(
+      GenericToolbox::Json::fetchValue(_config_, "enableSplineBatches", _eventDialCache_.isSplineBatchesEnabled())
+  );
+  _eventDialCache_.setSortEventsByBin(
+      GenericToolbox::Json::fetchValue(_config_, "sortEventsByBin", _eventDialCache_.isSortEventsByBin())
+  );
+  _eventDialCache_.setEnableIncrementalReweight(
+      GenericToolbox::Json::fetchValue(_config_, "enableIncrementalReweight", _eventDialCache_.isIncrementalReweightEnabled())
+  );
+  _eventDialCache_.setThreadChunkSize(
+      GenericToolbox::Json::fetchValue(_config_, "reweightChunkSize", _eventDialCache_.getThreadChunkSize())
+  );
+  _eventDialCache_.setIncrementalReweightMaxFraction(
+      GenericToolbox::Json::fetchValue(_config_, "incrementalReweightMaxFraction", _eventDialCache_.getIncrementalReweightMaxFraction())
+  );
+  _eventDialCache_.getDialProfiler().setEnabled(
+      GenericToolbox::Json::fetchValue(_config_, "enableDialProfiling", _eventDialCache_.getDialProfiler().isEnabled())
+  );
   if( GenericToolbox::Json::doKeyExist(_config_, "globalEventReweightCap") ){
     _eventDialCache_.getGlobalEventReweightCap().isEnabled = true;
     _eventDialCache_.getGlobalEventReweightCap().maxReweight = GenericToolbox::Json::fetchValue<double>(_config_, "globalEventReweightCap");
   }
 
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  // only worth it when few parameters move at each step (Hesse, scans)
+  Cache::Manager::SetUsePartialProducts(
+      GenericToolbox::Json::fetchValue(_config_, "enableCacheManagerPartialProducts", false)
+  );
+  _cacheManagerIndexWidth_ = GenericToolbox::Json::fetchValue(_config_, "cacheManagerIndexWidth", _cacheManagerIndexWidth_);
+#endif
+
 
   LogInfo << "Reading samples configuration..." << std::endl;
   auto fitSampleSetConfig = GenericToolbox::Json::fetchValue(_config_, {{"sampleSetConfig"}, {"fitSampleSetConfig"}}, JsonType());
@@ -150,6 +185,8 @@ void Propagator::buildDialCache(){
       dialInput.invalidateBuffers();
     }
   }
+
+  this->buildHistogramCellIndices();
 }
 void Propagator::propagateParameters(){
 
@@ -160,6 +197,14 @@ void Propagator::propagateParameters(){
     }
   }
 
+  // the fused pass can't be used with the incremental or the GPU reweight
+  if( _enableFusedReweightHistFill_
+      and not _eventDialCache_.isIncrementalReweightEnabled()
+      and not GundamGlobals::getEnableCacheManager() ){
+    this->reweightAndRefillMcHistograms();
+    return;
+  }
+
   this->reweightMcEvents();
   this->refillMcHistograms();
 
@@ -173,6 +218,7 @@ void Propagator::reweightMcEvents() {
   reweightTimer.start();
 
   resetEventWeights();
+  _eventDialCache_.resetWorkDispensers();
 
   bool usedGPU{false};
 #ifdef GUNDAM_USING_CACHE_MANAGER
@@ -181,20 +227,79 @@ void Propagator::reweightMcEvents() {
     usedGPU = Cache::Manager::Fill();
   }
 #endif
-  if( not usedGPU ){
+  if( usedGPU ){ _isFullHistogramRefillRequested_ = true; }
+  if( not usedGPU and _eventDialCache_.prepareIncrementalReweight() ){
+    // only the events depending on the updated dial inputs are reweighted
+    if( not _devSingleThreadReweight_ ){
+      GundamGlobals::getParallelWorker().runJob("Propagator::updateDirtyDialResponses");
+      GundamGlobals::getParallelWorker().runJob("Propagator::reweightDirtyMcEvents");
+    }
+    else{
+      _eventDialCache_.updateDirtyDialResponses(-1);
+      _eventDialCache_.reweightDirtyEntries(-1);
+    }
+    _eventDialCache_.getDialProfiler().countCall();
+
+    // only the bins containing the reweighted events will need a refill
+    if( not _isFullHistogramRefillRequested_ ){
+      for( auto iEvent : _eventDialCache_.getDirtyEventList() ){
+        auto& indices = _eventDialCache_.getEventRefList()[iEvent]->getIndices();
+        _sampleSet_.getSampleList()[indices.sample].getMcContainer().flagBinToRefill( indices.bin );
+      }
+    }
+  }
+  else if( not usedGPU ){
+    _isFullHistogramRefillRequested_ = true;
     if( not _devSingleThreadReweight_ ){
+      if( _eventDialCache_.isTwoPhaseReweightEnabled() ){
+        // first evaluate each dial once, then gather the responses per event
+        GundamGlobals::getParallelWorker().runJob("Propagator::updateDialResponses");
+      }
       GundamGlobals::getParallelWorker().runJob("Propagator::reweightMcEvents");
     }
-    else{ this->reweightMcEvents(-1); }
+    else{
+      if( _eventDialCache_.isTwoPhaseReweightEnabled() ){ _eventDialCache_.updateDialResponses(-1); }
+      this->reweightMcEvents(-1);
+    }
+    if( _eventDialCache_.isTwoPhaseReweightEnabled() ){ _eventDialCache_.getDialProfiler().countCall(); }
   }
 
   reweightTimer.stop();
+
+  if( _validateMixedPrecision_ and _eventDialCache_.isMixedPrecisionEnabled() and not usedGPU ){
+    this->validateMixedPrecision();
+  }
 }
 void Propagator::refillMcHistograms(){
   refillHistogramTimer.start();
 
-  if( not _devSingleThreadHistFill_ ){ GundamGlobals::getParallelWorker().runJob("Propagator::refillMcHistograms"); }
-  else{ refillMcHistogramsFct(-1); }
+  if( _threadCellBoundList_.empty() and not _cellBinList_.empty() ){
+    // balance the bin ranges of the threads on their number of events
+    std::vector<double> cumulativeCost(_cellBinList_.size() + 1, 0);
+    for( size_t iCell = 0 ; iCell < _cellBinList_.size() ; iCell++ ){
+      cumulativeCost[iCell+1] = cumulativeCost[iCell] + 1 + double(
+          _sampleSet_.getSampleList()[_cellBinList_[iCell].first].getMcContainer()
+          .getHistogram().binList[_cellBinList_[iCell].second].eventPtrList.size()
+      );
+    }
+    _threadCellBoundList_ = GundamUtils::getCostBalancedBounds(
+        _cellBinList_.size(), GundamGlobals::getParallelWorker().getNbThreads(),
+        [&](size_t iCell_){ return cumulativeCost[iCell_]; }
+    );
+  }
+
+  if( not _isFullHistogramRefillRequested_ ){
+    // only the bins flagged by the incremental reweight
+    if( not _devSingleThreadHistFill_ ){ GundamGlobals::getParallelWorker().runJob("Propagator::refillDirtyMcHistograms"); }
+    else{ refillDirtyMcHistogramsFct(-1); }
+  }
+  else{
+    if( not _devSingleThreadHistFill_ ){ GundamGlobals::getParallelWorker().runJob("Propagator::refillMcHistograms"); }
+    else{ refillMcHistogramsFct(-1); }
+    _isFullHistogramRefillRequested_ = false;
+  }
+
+  for( auto& sample : _sampleSet_.getSampleList() ){ sample.getMcContainer().clearFlaggedBins(); }
 
   refillHistogramTimer.stop();
 }
@@ -239,6 +344,9 @@ std::string Propagator::getSampleBreakdownTableStr() const{
   ss << t.generateTableString();
   return ss.str();
 }
+std::string Propagator::getDialProfileTableStr() const{
+  return _eventDialCache_.getDialProfiler().getSummary();
+}
 void Propagator::printBreakdowns(){
   if( _showEventBreakdown_ ){
 
@@ -294,13 +402,18 @@ void Propagator::printBreakdowns(){
     std::cout << this->getSampleBreakdownTableStr() << std::endl;
 
   }
+  if( _eventDialCache_.getDialProfiler().isEnabled() ){
+    LogWarning << "Dial collection profile:" << std::endl;
+    std::cout << this->getDialProfileTableStr() << std::endl;
+  }
   if( _debugPrintLoadedEvents_ ){
     LogDebug << "Printing " << _debugPrintLoadedEventsNbPerSample_ << " events..." << std::endl;
     for( int iEvt = 0 ; iEvt < _debugPrintLoadedEventsNbPerSample_ ; iEvt++ ){
+      if( iEvt >= int(_eventDialCache_.getNbEvents()) ){ break; }
       LogDebug << "Event #" << iEvt << "{" << std::endl;
       {
         LogScopeIndent;
-        LogDebug << _eventDialCache_.getCache()[iEvt].getSummary() << std::endl;
+        LogDebug << _eventDialCache_.getCacheEntry(iEvt).getSummary() << std::endl;
       }
       LogDebug << "}" << std::endl;
     }
@@ -310,6 +423,21 @@ void Propagator::printBreakdowns(){
 // Protected
 void Propagator::initializeThreads() {
 
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::updateDialResponses",
+      [this](int iThread){ _eventDialCache_.updateDialResponses(iThread); }
+  );
+
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::updateDirtyDialResponses",
+      [this](int iThread){ _eventDialCache_.updateDirtyDialResponses(iThread); }
+  );
+
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::reweightDirtyMcEvents",
+      [this](int iThread){ _eventDialCache_.reweightDirtyEntries(iThread); }
+  );
+
   GundamGlobals::getParallelWorker().addJob(
       "Propagator::reweightMcEvents",
       [this](int iThread){ this->reweightMcEvents(iThread); }
@@ -320,6 +448,21 @@ void Propagator::initializeThreads() {
       [this](int iThread){ this->refillMcHistogramsFct(iThread); }
   );
 
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::refillDirtyMcHistograms",
+      [this](int iThread){ this->refillDirtyMcHistogramsFct(iThread); }
+  );
+
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::reweightAndFillMcHistograms",
+      [this](int iThread){ this->reweightAndFillMcHistogramsFct(iThread); }
+  );
+
+  GundamGlobals::getParallelWorker().addJob(
+      "Propagator::reduceMcHistograms",
+      [this](int iThread){ this->reduceMcHistogramsFct(iThread); }
+  );
+
 }
 
 // multithreading
@@ -328,21 +471,168 @@ void Propagator::reweightMcEvents(int iThread_) {
   //! Warning: everything you modify here, may significantly slow down the
   //! fitter
 
-  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
-      iThread_, GundamGlobals::getParallelWorker().getNbThreads(),
-      int(_eventDialCache_.getCache().size())
-  );
+  size_t begin, end;
+  int iFetch{0};
+  while( _eventDialCache_.getEventDispenser().fetch(iThread_, iFetch++, begin, end) ){
+    for( size_t iEvent = begin ; iEvent < end ; iEvent++ ){
+      _eventDialCache_.reweightEntry( iEvent );
+    }
+  }
+
+}
+void Propagator::refillMcHistogramsFct( int iThread_){
+  if( GundamGlobals::getEnableCacheManager() or _threadCellBoundList_.empty() ){
+    for( auto& sample : _sampleSet_.getSampleList() ){
+      sample.getMcContainer().refillHistogram(iThread_);
+    }
+    return;
+  }
+
+  // contiguous range of bins with a similar number of events
+  size_t begin{0}, end{_cellBinList_.size()};
+  if( iThread_ != -1 ){
+    begin = _threadCellBoundList_[iThread_];
+    end = _threadCellBoundList_[iThread_+1];
+  }
+  for( size_t iCell = begin ; iCell < end ; iCell++ ){
+    _sampleSet_.getSampleList()[_cellBinList_[iCell].first].getMcContainer().refillBin( _cellBinList_[iCell].second );
+  }
+}
+void Propagator::validateMixedPrecision() const{
+  // compare the weights of the float path with the full double evaluation
+  double maxRelDiff{0};
+  for( size_t iEvent = 0 ; iEvent < _eventDialCache_.getNbEvents() ; iEvent++ ){
+    auto* eventPtr = _eventDialCache_.getEventRefList()[iEvent];
+    double doubleWeight{eventPtr->getWeights().base * _eventDialCache_.evalEntryReweight(iEvent)};
+    if( doubleWeight == 0 ){ continue; }
+    maxRelDiff = std::max(maxRelDiff, std::abs(eventPtr->getWeights().current / doubleWeight - 1.));
+  }
+  LogAlertIf(maxRelDiff > _mixedPrecisionTolerance_) << "Mixed precision: max relative weight deviation is " << maxRelDiff
+                                                     << " > " << _mixedPrecisionTolerance_ << std::endl;
+}
+void Propagator::refillDirtyMcHistogramsFct( int iThread_){
+  for( auto& sample : _sampleSet_.getSampleList() ){
+    sample.getMcContainer().refillFlaggedBins(iThread_);
+  }
+}
+void Propagator::reweightAndFillMcHistogramsFct( int iThread_){
+
+  //! Warning: everything you modify here, may significantly slow down the
+  //! fitter
+
+  // private (w, w^2) accumulators: no need for any lock
+  auto& cellBuffer = _threadCellBufferList_[iThread_ == -1 ? 0 : iThread_];
+  std::fill( cellBuffer.begin(), cellBuffer.end(), 0 );
+
+  double weight;
+  size_t begin, end;
+  int iFetch{0};
+  while( _eventDialCache_.getEventDispenser().fetch(iThread_, iFetch++, begin, end) ){
+    for( size_t iEvent = begin ; iEvent < end ; iEvent++ ){
+      _eventDialCache_.reweightEntry( iEvent );
+
+      // while the event is still hot in the cache
+      if( _eventCellIndexList_[iEvent] < 0 ){ continue; }
+      weight = _eventDialCache_.getEventRefList()[iEvent]->getEventWeight();
+      cellBuffer[2*_eventCellIndexList_[iEvent]] += weight;
+      cellBuffer[2*_eventCellIndexList_[iEvent]+1] += weight * weight;
+    }
+  }
+
+}
+void Propagator::reduceMcHistogramsFct( int iThread_){
+  int nThreads{GundamGlobals::getParallelWorker().getNbThreads()};
+  if( iThread_ == -1 ){ iThread_ = 0; nThreads = 1; }
 
-  std::for_each(
-      _eventDialCache_.getCache().begin() + bounds.beginIndex,
-      _eventDialCache_.getCache().begin() + bounds.endIndex,
-      [this]( EventDialCache::CacheEntry& cache_){ _eventDialCache_.reweightEntry(cache_); }
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, nThreads, int(_cellBinList_.size())
   );
 
+  for( int iCell = bounds.beginIndex ; iCell < bounds.endIndex ; iCell++ ){
+    auto& bin = _sampleSet_.getSampleList()[_cellBinList_[iCell].first].getMcContainer().getHistogram().binList[_cellBinList_[iCell].second];
+    bin.content = 0;
+    bin.error = 0;
+    for( auto& cellBuffer : _threadCellBufferList_ ){
+      bin.content += cellBuffer[2*iCell];
+      bin.error += cellBuffer[2*iCell+1];
+    }
+    bin.error = sqrt(bin.error);
+  }
 }
-void Propagator::refillMcHistogramsFct( int iThread_){
+void Propagator::buildHistogramCellIndices(){
+  LogInfo << "Building the histogram cell indices..." << std::endl;
+
+  std::vector<int> sampleCellOffsetList(_sampleSet_.getSampleList().size(), 0);
+  _cellBinList_.clear();
   for( auto& sample : _sampleSet_.getSampleList() ){
-    sample.getMcContainer().refillHistogram(iThread_);
+    sampleCellOffsetList[sample.getIndex()] = int(_cellBinList_.size());
+    for( int iBin = 0 ; iBin < sample.getMcContainer().getHistogram().nBins ; iBin++ ){
+      _cellBinList_.emplace_back( sample.getIndex(), iBin );
+    }
+  }
+
+  // the bin event lists are not filled yet
+  _threadCellBoundList_.clear();
+
+  // only needed by the fused reweight
+  if( not _enableFusedReweightHistFill_ ){ return; }
+
+  _eventCellIndexList_.clear();
+  _eventCellIndexList_.resize( _eventDialCache_.getNbEvents(), -1 );
+  for( size_t iEvent = 0 ; iEvent < _eventDialCache_.getNbEvents() ; iEvent++ ){
+    auto& indices = _eventDialCache_.getEventRefList()[iEvent]->getIndices();
+    if( indices.bin < 0 ){ continue; }
+    _eventCellIndexList_[iEvent] = sampleCellOffsetList[indices.sample] + indices.bin;
+  }
+
+  _threadCellBufferList_.clear();
+  _threadCellBufferList_.resize(
+      std::max(GundamGlobals::getParallelWorker().getNbThreads(), 1),
+      std::vector<double>(2*_cellBinList_.size(), 0)
+  );
+}
+void Propagator::reweightAndRefillMcHistograms(){
+  reweightTimer.start();
+
+  resetEventWeights();
+  _eventDialCache_.resetWorkDispensers();
+
+  // the reweight and the fill of the thread buffers are timed as the
+  // reweight, the reduction of the buffers into the histograms as the refill
+  if( not _devSingleThreadReweight_ ){
+    if( _eventDialCache_.isTwoPhaseReweightEnabled() ){
+      GundamGlobals::getParallelWorker().runJob("Propagator::updateDialResponses");
+    }
+    GundamGlobals::getParallelWorker().runJob("Propagator::reweightAndFillMcHistograms");
+  }
+  else{
+    if( _eventDialCache_.isTwoPhaseReweightEnabled() ){ _eventDialCache_.updateDialResponses(-1); }
+    // only the first thread buffer is used
+    for( size_t iThread = 1 ; iThread < _threadCellBufferList_.size() ; iThread++ ){
+      std::fill( _threadCellBufferList_[iThread].begin(), _threadCellBufferList_[iThread].end(), 0 );
+    }
+    this->reweightAndFillMcHistogramsFct(-1);
+  }
+  if( _eventDialCache_.isTwoPhaseReweightEnabled() ){ _eventDialCache_.getDialProfiler().countCall(); }
+
+  reweightTimer.stop();
+  refillHistogramTimer.start();
+
+  if( not _devSingleThreadReweight_ ){
+    GundamGlobals::getParallelWorker().runJob("Propagator::reduceMcHistograms");
+  }
+  else{
+    this->reduceMcHistogramsFct(-1);
+  }
+
+  // the histograms are now in sync with the event weights
+  _isFullHistogramRefillRequested_ = false;
+  for( auto& sample : _sampleSet_.getSampleList() ){ sample.getMcContainer().clearFlaggedBins(); }
+
+  refillHistogramTimer.stop();
+
+  if( _validateMixedPrecision_ and _eventDialCache_.isMixedPrecisionEnabled() ){
+    this->validateMixedPrecision();
   }
 }
 
@@ -31,6 +31,9 @@ public:
       double error{0};
       const DataBin* dataBinPtr{nullptr};
       std::vector<Event*> eventPtrList{};
+      // [eventBegin, eventEnd) in the event list if it is sorted by bin
+      size_t eventBegin{0};
+      size_t eventEnd{0};
     };
     std::vector<Bin> binList{};
     int nBins{0};
@@ -46,16 +49,27 @@ public:
   [[nodiscard]] const std::string& getName() const{ return _name_; }
   [[nodiscard]] const std::vector<Event> &getEventList() const{ return _eventList_; }
   [[nodiscard]] const Histogram &getHistogram() const{ return _histogram_; }
+  [[nodiscard]] bool isEventListSortedByBin() const{ return _isEventListSortedByBin_; }
 
   // mutable-getters
   std::vector<Event> &getEventList(){ return _eventList_; }
+  Histogram &getHistogram(){ return _histogram_; }
 
   // core
   void buildHistogram(const DataBinSet& binning_);
   void reserveEventMemory(size_t dataSetIndex_, size_t nEvents, const Event &eventBuffer_);
   void shrinkEventList(size_t newTotalSize_);
+  // to be called outside the threads, before the threaded updateBinEventList
+  void updateEventListSortedByBin();
   void updateBinEventList(int iThread_ = -1);
   void refillHistogram(int iThread_ = -1);
+  void refillBin(int iBin_){ this->refillBin(_histogram_.binList[iBin_]); }
+
+  // delta refill: only the flagged bins are summed again
+  void flagBinToRefill(int iBin_);
+  void refillFlaggedBins(int iThread_ = -1);
+  void clearFlaggedBins();
+  [[nodiscard]] const std::vector<int>& getBinToRefillList() const{ return _binToRefillList_; }
 
   // event by event poisson throw -> takes into account the finite amount of stat in MC
   void throwEventMcError();
@@ -72,10 +86,17 @@ public:
   friend std::ostream& operator <<( std::ostream& o, const SampleElement& this_ );
 
 private:
+  void refillBin(Histogram::Bin& bin_);
+
   std::string _name_{};
   Histogram _histogram_{};
   std::vector<Event> _eventList_{};
   std::vector<DatasetProperties> _loadedDatasetList_{};
+  bool _isEventListSortedByBin_{false};
+
+  // bins flagged for the delta refill
+  std::vector<int> _binToRefillList_{};
+  std::vector<uint8_t> _isBinToRefillList_{};
 
 #ifdef GUNDAM_USING_CACHE_MANAGER
 public:
@@ -9,6 +9,8 @@
 
 #include "TRandom.h"
 
+#include <algorithm>
+
 
 LoggerInit([]{ Logger::setUserHeaderStr("[SampleElement]"); });
 
@@ -62,15 +64,35 @@ void SampleElement::shrinkEventList(size_t newTotalSize_){
   _eventList_.resize(newTotalSize_);
   _eventList_.shrink_to_fit();
 }
+void SampleElement::updateEventListSortedByBin(){
+  // if the events are sorted by bin, the events of each bin are contiguous
+  _isEventListSortedByBin_ = std::is_sorted(_eventList_.begin(), _eventList_.end(), [](const Event& a_, const Event& b_){
+    return a_.getIndices().bin < b_.getIndices().bin;
+  });
+}
 void SampleElement::updateBinEventList(int iThread_) {
   int nbThreads = GundamGlobals::getParallelWorker().getNbThreads();
-  if( iThread_ == -1 ){ iThread_ = 0; nbThreads = 1; }
+  if( iThread_ == -1 ){ iThread_ = 0; nbThreads = 1; this->updateEventListSortedByBin(); }
 
   if( iThread_ == 0 ){ LogScopeIndent; LogInfo << "Filling bin event cache for \"" << _name_ << "\"..." << std::endl; }
 
   // multithread technique with iBin += nbThreads;
   int iBin{iThread_};
   while( iBin < _histogram_.nBins ){
+    if( _isEventListSortedByBin_ ){
+      auto& bin = _histogram_.binList[iBin];
+      auto beginIt = std::lower_bound(_eventList_.begin(), _eventList_.end(), iBin, [](const Event& e_, int iBin_){ return e_.getIndices().bin < iBin_; });
+      auto endIt = std::upper_bound(beginIt, _eventList_.end(), iBin, [](int iBin_, const Event& e_){ return iBin_ < e_.getIndices().bin; });
+      bin.eventBegin = size_t(std::distance(_eventList_.begin(), beginIt));
+      bin.eventEnd = size_t(std::distance(_eventList_.begin(), endIt));
+      bin.eventPtrList.resize(bin.eventEnd - bin.eventBegin, nullptr);
+      for( size_t iEvent = bin.eventBegin ; iEvent < bin.eventEnd ; iEvent++ ){
+        bin.eventPtrList[iEvent - bin.eventBegin] = &_eventList_[iEvent];
+      }
+      iBin += nbThreads;
+      continue;
+    }
+
     size_t count = std::count_if(_eventList_.begin(), _eventList_.end(), [&]( auto& e) {return e.getIndices().bin == iBin;});
     _histogram_.binList[iBin].eventPtrList.resize(count, nullptr);
 
@@ -102,52 +124,85 @@ void SampleElement::refillHistogram(int iThread_){
   // Faster that pointer shifter. -> would be slower if refillHistogram is
   // handled by the propagator
   int iBin = iThread_; // iBin += nbThreads;
-  Histogram::Bin* binPtr;
-  double buffer{};
   while( iBin < _histogram_.nBins ){
-    binPtr = &_histogram_.binList[iBin];
-    binPtr->content = 0;
-    binPtr->error = 0;
+    this->refillBin( _histogram_.binList[iBin] );
+    iBin += nThreads;
+  }
+
+}
+void SampleElement::flagBinToRefill(int iBin_){
+  if( iBin_ < 0 or iBin_ >= _histogram_.nBins ){ return; }
+  if( _isBinToRefillList_.size() != _histogram_.binList.size() ){
+    _isBinToRefillList_.resize(_histogram_.binList.size(), false);
+  }
+  if( _isBinToRefillList_[iBin_] ){ return; }
+  _isBinToRefillList_[iBin_] = true;
+  _binToRefillList_.emplace_back(iBin_);
+}
+void SampleElement::refillFlaggedBins(int iThread_){
+  int nThreads = GundamGlobals::getParallelWorker().getNbThreads();
+  if( iThread_ == -1 ){ nThreads = 1; iThread_ = 0; }
+
+  // only the bins containing reweighted events are summed again
+  for( size_t iEntry = iThread_ ; iEntry < _binToRefillList_.size() ; iEntry += nThreads ){
+    this->refillBin( _histogram_.binList[_binToRefillList_[iEntry]] );
+  }
+}
+void SampleElement::clearFlaggedBins(){
+  for( auto& iBin : _binToRefillList_ ){ _isBinToRefillList_[iBin] = false; }
+  _binToRefillList_.clear();
+}
+void SampleElement::refillBin(Histogram::Bin& bin_){
+  Histogram::Bin* binPtr{&bin_};
+  double buffer{};
+  binPtr->content = 0;
+  binPtr->error = 0;
 #ifdef GUNDAM_USING_CACHE_MANAGER
-    if (_CacheManagerValue_ !=nullptr and _CacheManagerIndex_ >= 0) {
-      const double ew = _CacheManagerValue_[_CacheManagerIndex_+binPtr->index];
-      const double ew2 = _CacheManagerValue2_[_CacheManagerIndex_+binPtr->index];
-      binPtr->content += ew;
-      binPtr->error += ew2;
+  if (_CacheManagerValue_ !=nullptr and _CacheManagerIndex_ >= 0) {
+    const double ew = _CacheManagerValue_[_CacheManagerIndex_+binPtr->index];
+    const double ew2 = _CacheManagerValue2_[_CacheManagerIndex_+binPtr->index];
+    binPtr->content += ew;
+    binPtr->error += ew2;
 #ifdef CACHE_MANAGER_SLOW_VALIDATION
-      double content = binContentArray[iBin+1];
-      double slowValue = 0.0;
-      for( auto* eventPtr : perBinEventPtrList.at(iBin)){
-        slowValue += eventPtr->getEventWeight();
-      }
-      double delta = std::abs(slowValue-content);
-      if (delta > 1E-6) {
-        LogInfo << "VALIDATION: Mismatched bin: " << _CacheManagerIndex_
-                << "+" << iBin
-                << "(" << name
-                << ") gpu: " << content
-                << " PhysEvt: " << slowValue
-                << " delta: " << delta
-                << std::endl;
-      }
-#endif // CACHE_MANAGER_SLOW_VALIDATION
+    double content = binContentArray[binPtr->index+1];
+    double slowValue = 0.0;
+    for( auto* eventPtr : perBinEventPtrList.at(binPtr->index)){
+      slowValue += eventPtr->getEventWeight();
+    }
+    double delta = std::abs(slowValue-content);
+    if (delta > 1E-6) {
+      LogInfo << "VALIDATION: Mismatched bin: " << _CacheManagerIndex_
+              << "+" << binPtr->index
+              << "(" << name
+              << ") gpu: " << content
+              << " PhysEvt: " << slowValue
+              << " delta: " << delta
+              << std::endl;
     }
-    else {
+#endif // CACHE_MANAGER_SLOW_VALIDATION
+  }
+  else {
 #endif
+    if( _isEventListSortedByBin_ ){
+      // streaming over a contiguous range of events
+      for( size_t iEvent = binPtr->eventBegin ; iEvent < binPtr->eventEnd ; iEvent++ ){
+        buffer = _eventList_[iEvent].getEventWeight();
+        binPtr->content += buffer;
+        binPtr->error += buffer * buffer;
+      }
+    }
+    else{
       for (auto *eventPtr: binPtr->eventPtrList) {
         buffer = eventPtr->getEventWeight();
         binPtr->content += buffer;
         binPtr->error += buffer * buffer;
       }
-#ifdef GUNDAM_USING_CACHE_MANAGER
     }
-#endif // GUNDAM_USING_CACHE_MANAGER
-    binPtr->error = sqrt(binPtr->error);
-    iBin += nThreads;
+#ifdef GUNDAM_USING_CACHE_MANAGER
   }
-
+#endif // GUNDAM_USING_CACHE_MANAGER
+  binPtr->error = sqrt(binPtr->error);
 }
-
 void SampleElement::throwEventMcError(){
   /*
    * This is to take into account the finite amount of event
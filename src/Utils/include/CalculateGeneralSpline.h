@@ -25,19 +25,21 @@
 #define DEVICE_FLOATING_POINT double
 #endif
 
+#include "CalculateKnotIndex.h"
+
 // Place in a private name space so it plays nicely with CUDA
 namespace {
-    // Interpolate one point a spline with non-uniform points.  The spline can
-    // have at most 15 knots defined.  With optimization (O1 or more), this
-    // about forty times faster than TSpline3.
+    // Interpolate one point a spline with non-uniform points.  With
+    // optimization (O1 or more), this about forty times faster than TSpline3.
     //
     // This takes the "index" of the point in the data, the parameter value
     // (that made the index), a minimum and maximum bound, the buffer of data
     // for this spline, and the number of data elements in the spline data.
     // The input data is arrange as
     //
-    // data[0] -- spline lower bound (not used, kept to match other splines)
-    // data[1] -- spline step (not used, kept to match other splines)
+    // data[0] -- spline lower bound (only used as a hint to find the knot)
+    // data[1] -- inverse of the spline average step (only used as a hint to
+    //            find the knot, stored when the spline is built)
     // data[2+3*n+0] -- The function value for knot n
     // data[2+3*n+1] -- The function slope for knot n
     // data[2+3*n+2] -- The point for knot n
@@ -52,26 +54,13 @@ namespace {
                                   const DEVICE_FLOATING_POINT* data,
                                   const int dim) {
 
-        // Check to find a point that is less than x.  This is "brute force",
-        // but since we know that the splines will usually have 7 or fewer
-        // points, this will be faster, or comparable, to binary search.
+        // Find the segment containing x.  The knots are usually evenly
+        // spaced, so first try the segment given by the lower bound and
+        // step, and otherwise do a binary search.  Any number of knots is
+        // supported.
         const int knotCount = (dim-2)/3;
-        int ix = 0;
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 1
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 2
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 3
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 4
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 5
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 6
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 7
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 8
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 9
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 10
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 11
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 12
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 13
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 14
-        if (x > data[2+3*(ix+1)+2] && ix < knotCount-2) ++ix; // 15
+        const int ix = CalculateKnotIndexWithGuess(x, data[0], data[1],
+                                                   data+4, 3, knotCount);
 
         const double x1 = data[2+3*ix+2];
         const double x2 = data[2+3*(ix+1)+2];
@@ -99,6 +88,64 @@ namespace {
 
         return v;
     }
+
+    // Interpolate one point of a spline with the knot positions stored apart
+    // from the values and slopes, so they can be shared between the splines
+    // built on the same grid.  The input data is arranged as
+    //
+    // data[2*n+0] -- The function value for knot n
+    // data[2*n+1] -- The function slope for knot n
+    // knots[n] -- The point for knot n
+    //
+    // The "step" is the average knot spacing and "invStep" its inverse.
+    // When "uniform" is true, the knots are evenly spaced so the segment and
+    // the position in the segment come from the step without looking at the
+    // knots.  Otherwise, this looks up the segment like
+    // CalculateGeneralSpline.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGeneralSplineOnGrid(const double x,
+                                        const double lowerBound,
+                                        double upperBound,
+                                        const DEVICE_FLOATING_POINT* data,
+                                        const DEVICE_FLOATING_POINT* knots,
+                                        const int knotCount,
+                                        const double step,
+                                        const double invStep,
+                                        const bool uniform) {
+        int ix = 0;
+        double fx = 0.0;
+        double segment = step;
+        if (uniform) {
+            const int last = knotCount-2;
+            const double r = (x - knots[0])*invStep;
+            // The negated comparison also sends NaN to the first segment.
+            if (!(r < last)) ix = last;
+            else if (r > 0.0) ix = int(r);
+            fx = r - ix;
+        }
+        else {
+            ix = CalculateKnotIndexWithGuess(x, knots[0], invStep,
+                                             knots, 1, knotCount);
+            segment = knots[ix+1]-knots[ix];
+            fx = (x - knots[ix])/segment;
+        }
+
+        const double p1 = data[2*ix];
+        const double m1 = data[2*ix+1]*segment;
+        const double p2 = data[2*(ix+1)];
+        const double m2 = data[2*(ix+1)+1]*segment;
+
+        // Factored via Horner's method.
+        double v = ((((2.0*p1 - 2.0*p2 + m2 + m1)*fx
+                      + 3.0*p2 - 3.0*p1 - m2 - 2.0*m1)*fx
+                     +m1)*fx
+                    +p1);
+
+        if (v < lowerBound) v = lowerBound;
+        if (v > upperBound) v = upperBound;
+
+        return v;
+    }
 }
 
 // An MIT Style License
@@ -24,10 +24,11 @@
 #define DEVICE_FLOATING_POINT double
 #endif
 
+#include "CalculateKnotIndex.h"
+
 // Place in a private name space so it plays nicely with CUDA
 namespace {
-    /// Interpolate one point in a graph with non-uniform points.  The graph can
-    /// have at most 15 knots defined.
+    /// Interpolate one point in a graph with non-uniform points.
     ///
     /// This takes the parameter value, a minimum and maximum bound, the
     /// buffer of data for this graph, and the number of data elements in the
@@ -49,26 +50,16 @@ namespace {
         // Short circuit 1 point graphs.
         if (dim < 4) return data[0];
 
-        // Check to find a point that is less than x.  This is "brute force"
-        // and does more comparisons than a binary search, but simpler
-        // calculations.
+        // Find the segment containing x.  Try the segment expected for
+        // evenly spaced knots first, and otherwise do a binary search.  Any
+        // number of knots is supported.  The graph data has no room for the
+        // inverse of the average spacing, so it's computed here (the Cache
+        // Manager host groups store it with the knots).
         const int knotCount = (dim)/2;
-        int ix = 0;
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 1
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 2
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 3
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 4
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 5
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 6
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 7
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 8
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 9
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 10
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 11
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 12
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 13
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 14
-        if (x > data[2*(ix+1)+1] && ix < knotCount-2) ++ix; // 15
+        const double firstKnot = data[1];
+        const double invAverageStep = (knotCount-1)/(data[2*(knotCount-1)+1]-firstKnot);
+        const int ix = CalculateKnotIndexWithGuess(x, firstKnot, invAverageStep,
+                                                   data+1, 2, knotCount);
 
         const double p1 = data[2*ix];
         const double x1 = data[2*ix+1];
@@ -0,0 +1,225 @@
+#ifndef CalculateGridSpline_h_SEEN
+#define CalculateGridSpline_h_SEEN
+// Calculate an interpolation on a rectilinear grid of knots with several
+// inputs (a tensor product of one dimensional interpolations).  This adds a
+// function that can be called from CPU (with c++), or a GPU (with CUDA).
+
+// Wrap the CUDA compiler attributes into a definition.  When this is compiled
+// with a CUDA compiler __CUDACC__ will be defined.  In that case, the code
+// will be compiled with cuda attributes for both the host (i.e. __host__) and
+// gpu (i.e. __device__).  If it's compiled with a normal C compiler, this is
+// compiled as inline.
+#ifndef DEVICE_CALLABLE_INLINE
+#ifdef __CUDACC__
+// This is used with a cuda compiler (i.e. nvcc)
+#define DEVICE_CALLABLE_INLINE __host__ __device__ inline
+#else
+// This is used for a non-cuda compiler
+#define DEVICE_CALLABLE_INLINE /* __host__ __device__ inline */
+#endif
+#endif
+
+// Make it easy to override the floating point type.  This would normally be
+// done using a typedef, but that doesn't play well with the CUDA compiler.
+#ifndef DEVICE_FLOATING_POINT
+#define DEVICE_FLOATING_POINT double
+#endif
+
+// The maximum number of inputs of a grid.  The cost of an evaluation is
+// 2^N (linear) or 4^N (cubic) knot values.
+#ifndef GRID_SPLINE_MAX_DIMENSION
+#define GRID_SPLINE_MAX_DIMENSION 3
+#endif
+
+#include "CalculateKnotIndex.h"
+
+// Place in a private name space so it plays nicely with CUDA
+namespace {
+    /// Interpolate one point on a grid of knots.
+    ///
+    /// This takes the input values (one per dimension), a minimum and
+    /// maximum bound for the result, the buffer of data for this grid, and
+    /// the number of data elements.  The input data is arranged as
+    ///
+    /// data[0] -- The number of dimensions N (at most GRID_SPLINE_MAX_DIMENSION)
+    /// data[1] -- 0 for multilinear, 1 for Catmull-Rom cubic interpolation
+    /// data[2] -- 1 if the inputs are extrapolated outside of the grid
+    /// data[3] to data[3+N-1] -- The number of knots, n(d), for each dimension.
+    /// followed by the knot positions of each dimension (in increasing order)
+    /// followed by the values at the knots, with the first dimension running
+    ///     fastest (i.e. value(i0,i1) is at i0 + n(0)*i1).
+    ///
+    /// The cubic interpolation uses the Catmull-Rom slopes (the slope between
+    /// the neighbouring knots), which are linear in the knot values.  Each
+    /// dimension then gives a weight to its 4 closest knots, and the result
+    /// is the sum of the knot values times the product of the weights.
+    ///
+    /// NOTE: This is similar to CalculateCompactSpline, but the knots don't
+    /// need to be evenly spaced.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGridSpline(const double* x,
+                               const double lowerBound, double upperBound,
+                               const DEVICE_FLOATING_POINT* data,
+                               const int dim) {
+        const int nDim = int(data[0]);
+        const bool cubic = (data[1] > 0.5);
+        const bool extrapolate = (data[2] > 0.5);
+
+        // The knot index and the weight of each knot used in each dimension.
+        int knotIndex[GRID_SPLINE_MAX_DIMENSION][4];
+        double knotWeight[GRID_SPLINE_MAX_DIMENSION][4];
+        int knotUsed[GRID_SPLINE_MAX_DIMENSION];
+        int stride[GRID_SPLINE_MAX_DIMENSION];
+
+        const DEVICE_FLOATING_POINT* knots = data + 3 + nDim;
+        int valueStride = 1;
+        for (int d = 0; d < nDim; ++d) {
+            const int knotCount = int(data[3+d]);
+            stride[d] = valueStride;
+            valueStride *= knotCount;
+
+            if (knotCount < 2) {
+                knotIndex[d][0] = 0;
+                knotWeight[d][0] = 1.0;
+                knotUsed[d] = 1;
+                knots += knotCount;
+                continue;
+            }
+
+            double v = x[d];
+            if (!extrapolate) {
+                if (v < knots[0]) v = knots[0];
+                if (v > knots[knotCount-1]) v = knots[knotCount-1];
+            }
+
+            const double invAverageStep
+                = (knotCount-1)/(knots[knotCount-1]-knots[0]);
+            const int ix = CalculateKnotIndexWithGuess(v, knots[0],
+                                                       invAverageStep,
+                                                       knots, 1, knotCount);
+            const double x1 = knots[ix];
+            const double x2 = knots[ix+1];
+            const double step = x2-x1;
+            const double fx = (v-x1)/step;
+
+            if (!cubic) {
+                knotIndex[d][0] = ix;
+                knotIndex[d][1] = ix+1;
+                knotWeight[d][0] = 1.0-fx;
+                knotWeight[d][1] = fx;
+                knotUsed[d] = 2;
+                knots += knotCount;
+                continue;
+            }
+
+            // The outer knots are clamped to the grid, so the slope at the
+            // edges is the slope of the edge segment.
+            const int i0 = (ix > 0) ? ix-1 : ix;
+            const int i3 = (ix+2 < knotCount) ? ix+2 : ix+1;
+            const double x0 = knots[i0];
+            const double x3 = knots[i3];
+
+            const double fx2 = fx*fx;
+            const double fx3 = fx2*fx;
+            const double h00 = 2.0*fx3 - 3.0*fx2 + 1.0;
+            const double h10 = fx3 - 2.0*fx2 + fx;
+            const double h01 = -2.0*fx3 + 3.0*fx2;
+            const double h11 = fx3 - fx2;
+            const double a = h10*step/(x2-x0);
+            const double b = h11*step/(x3-x1);
+
+            knotIndex[d][0] = i0;
+            knotIndex[d][1] = ix;
+            knotIndex[d][2] = ix+1;
+            knotIndex[d][3] = i3;
+            knotWeight[d][0] = -a;
+            knotWeight[d][1] = h00 - b;
+            knotWeight[d][2] = h01 + a;
+            knotWeight[d][3] = b;
+            knotUsed[d] = 4;
+            knots += knotCount;
+        }
+
+        // The knots are followed by the values.
+        const DEVICE_FLOATING_POINT* values = knots;
+
+        // Loop over all of the combinations of the knots used in each
+        // dimension.
+        int combinations = 1;
+        for (int d = 0; d < nDim; ++d) combinations *= knotUsed[d];
+
+        double v = 0.0;
+        for (int c = 0; c < combinations; ++c) {
+            int rest = c;
+            int offset = 0;
+            double weight = 1.0;
+            for (int d = 0; d < nDim; ++d) {
+                const int k = rest % knotUsed[d];
+                rest /= knotUsed[d];
+                offset += stride[d]*knotIndex[d][k];
+                weight *= knotWeight[d][k];
+            }
+            v += weight*values[offset];
+        }
+
+        if (v < lowerBound) v = lowerBound;
+        if (v > upperBound) v = upperBound;
+
+        return v;
+    }
+}
+
+#ifdef TEST_CALCULATE_GRID_SPLINE
+// Compile and test with
+//
+// cp CalculateGridSpline.h temp.cpp
+// g++ -DTEST_CALCULATE_GRID_SPLINE temp.cpp
+// ./a.out
+#include <iostream>
+int main(int argc, char** argv) {
+    // f(x,y) = x + 2*y on a 3x2 grid.
+    double data[]{
+        2.0, 0.0, 0.0,
+            3.0, 2.0,
+            0.0, 1.0, 3.0,
+            0.0, 1.0,
+            0.0, 1.0, 3.0,
+            2.0, 3.0, 5.0};
+
+    for (double x = -1.0; x<4.0; x += 0.5) {
+        double in[]{x, 0.25};
+        double v = CalculateGridSpline(in,-1E20,1E20,data,18);
+        std::cout << x << " " << v << std::endl;
+    }
+    return 0;
+}
+#endif
+
+// An MIT Style License
+
+// Copyright (c) 2022 Clark McGrew
+
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// compile-command:"$(git rev-parse --show-toplevel)/cmake/gundam-build.sh"
+// End:
+#endif
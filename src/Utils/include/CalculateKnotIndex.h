@@ -0,0 +1,84 @@
+//
+// Created on 17/10/2026.
+//
+
+#ifndef CALCULATE_KNOT_INDEX_H_SEEN
+#define CALCULATE_KNOT_INDEX_H_SEEN
+// Find the knot segment containing a point for splines and graphs with
+// non-uniform knots.  This is shared between CalculateGeneralSpline and
+// CalculateGraph, and can be called from CPU (with c++), or a GPU (with
+// CUDA).
+
+// Wrap the CUDA compiler attributes into a definition.  When this is compiled
+// with a CUDA compiler __CUDACC__ will be defined.  In that case, the code
+// will be compiled with cuda attributes for both the host (i.e. __host__) and
+// gpu (i.e. __device__).  If it's compiled with a normal C compiler, this is
+// compiled as inline.
+#ifndef DEVICE_CALLABLE_INLINE
+#ifdef __CUDACC__
+// This is used with a cuda compiler (i.e. nvcc)
+#define DEVICE_CALLABLE_INLINE __host__ __device__ inline
+#else
+// This is used for a non-cuda compiler
+#define DEVICE_CALLABLE_INLINE /* __host__ __device__ inline */
+#endif
+#endif
+
+// Allow the floating point type to be overriden.  This would normally be done
+// using a typedef, but that doesn't play well with the CUDA compiler.
+#ifndef DEVICE_FLOATING_POINT
+#define DEVICE_FLOATING_POINT double
+#endif
+
+// Place in a private name space so it plays nicely with CUDA
+namespace {
+    // Find the index of the segment [knot(ix), knot(ix+1)] to use for x.
+    // The knot positions are read as knots[stride*n] and must be in
+    // increasing order.  The result is the number of knots strictly below x
+    // (not counting the first one), clamped to [0, knotCount-2], so points
+    // outside of the knots use the first or last segment.
+    //
+    // This is a binary search where the loop only depends on the knot count,
+    // and the comparison is turned into a conditional move, so there is no
+    // branch to mispredict.  The cost is log2(knotCount) loads.
+    DEVICE_CALLABLE_INLINE
+    int CalculateKnotIndex(const double x,
+                           const DEVICE_FLOATING_POINT* knots,
+                           const int stride,
+                           const int knotCount) {
+        int base = 0;
+        int n = knotCount-1;
+        while (n > 1) {
+            const int half = n/2;
+            base = (x > knots[stride*(base+half)]) ? base+half : base;
+            n -= half;
+        }
+        return base;
+    }
+
+    // Same as CalculateKnotIndex, but first try the segment found assuming
+    // the knots are evenly spaced from "lowerBound", "invStep" being the
+    // inverse of the spacing.  When the knots really are uniform (the usual
+    // case), that guess is right and the lookup is a couple of comparisons.
+    // Otherwise this falls back to the binary search.
+    DEVICE_CALLABLE_INLINE
+    int CalculateKnotIndexWithGuess(const double x,
+                                    const double lowerBound,
+                                    const double invStep,
+                                    const DEVICE_FLOATING_POINT* knots,
+                                    const int stride,
+                                    const int knotCount) {
+        if (knotCount < 3) return 0;
+        const int last = knotCount-2;
+        const double r = (x - lowerBound)*invStep;
+        // The negated comparisons also send NaN to the first segment.
+        int ix = 0;
+        if (!(r < last)) ix = last;
+        else if (r > 0.0) ix = int(r);
+        if ((ix == 0 || x > knots[stride*ix])
+            && (ix == last || !(x > knots[stride*(ix+1)]))) return ix;
+        return CalculateKnotIndex(x, knots, stride, knotCount);
+    }
+}
+
+#endif
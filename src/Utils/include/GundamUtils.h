@@ -31,6 +31,11 @@ namespace GundamUtils {
 
   std::string generateFileName(const CmdLineParser& clp_, const std::vector<std::pair<std::string, std::string>>& appendixDict_);
 
+  // split [0, nEntries_) into nThreads_ contiguous slices of similar cost.
+  // getCumulativeCost_(i) is the cost of the entries [0, i) and must be
+  // monotonic. Returns the nThreads_+1 slice boundaries.
+  std::vector<size_t> getCostBalancedBounds(size_t nEntries_, int nThreads_, const std::function<double(size_t)>& getCumulativeCost_);
+
   // dicts
   static const std::map<int, std::string> minuitStatusCodeStr{
       { 0 , "status = 0    : OK" },
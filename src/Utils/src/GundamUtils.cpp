@@ -97,6 +97,28 @@ namespace GundamUtils {
     return GenericToolbox::joinVectorString(appendixList, "_");
   }
 
+  std::vector<size_t> getCostBalancedBounds(size_t nEntries_, int nThreads_, const std::function<double(size_t)>& getCumulativeCost_){
+    if( nThreads_ < 1 ){ nThreads_ = 1; }
+    std::vector<size_t> out(nThreads_+1, nEntries_);
+    out[0] = 0;
+
+    double totalCost{getCumulativeCost_(nEntries_)};
+    for( int iThread = 1 ; iThread < nThreads_ ; iThread++ ){
+      double targetCost{totalCost * double(iThread) / double(nThreads_)};
+
+      // first entry for which the cumulative cost reaches the target
+      size_t low{out[iThread-1]}; size_t high{nEntries_};
+      while( low < high ){
+        size_t mid{low + (high - low) / 2};
+        if( getCumulativeCost_(mid) < targetCost ){ low = mid + 1; }
+        else{ high = mid; }
+      }
+      out[iThread] = low;
+    }
+
+    return out;
+  }
+
   bool ObjectReader::quiet{false};
   bool ObjectReader::throwIfNotFound{false};
   bool ObjectReader::readObject( TDirectory* f_, const std::string& objPath_){ return readObject<TObject>(f_, objPath_); }
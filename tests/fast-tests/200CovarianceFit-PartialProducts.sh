@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Set the base name for this test (should match the script name)
+BASE=200CovarianceFit
+
+# Get the directory containing the script from the command line
+# parameters (avoids bash trickery).  Use the current directory as the
+# default.
+DIR=.
+if [ ${#1} -gt 0 ]; then
+    DIR=${1}
+fi
+
+# Make sure that gundam has been setup.
+if ! which gundamFitter; then
+    echo FAIL: Executable not found for gundamFitter
+    exit 1
+fi
+
+# Set the expected locations for the config and output files.
+export CONFIG_DIR=${DIR}
+export DATA_DIR=${PWD}
+
+CONFIG_FILE=${CONFIG_DIR}/${BASE}-config.yaml
+
+# Run the same Cache::Manager fit with the product of all the weight
+# calculators, and with the partial product kept by each calculator.  The
+# parameter scans move a single parameter at a time, so between two
+# evaluations only the weight calculator of that parameter changes.
+for MODE in full partial; do
+    OUTPUT_FILE=${DATA_DIR}/${BASE}-PartialProducts-${MODE}.root
+    OVERRIDE_FILES=""
+    if [ ${MODE} == "partial" ]; then
+        OVERRIDE_FILES="-of ${CONFIG_DIR}/${BASE}-PartialProducts.yaml"
+    fi
+
+    echo ${OUTPUT_FILE}
+    echo ${CONFIG_FILE} ${OVERRIDE_FILES}
+
+    gundamFitter --cache-manager -t 1 -s 10000 --scan 10 \
+                 -c ${CONFIG_FILE} ${OVERRIDE_FILES} -o ${OUTPUT_FILE}
+done
+
+# End of the script
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Set the base name for this test (should match the script name)
+BASE=200ReweightModes
+
+# Get the directory containing the script from the command line
+# parameters (avoids bash trickery).  Use the current directory as the
+# default.
+DIR=.
+if [ ${#1} -gt 0 ]; then
+    DIR=${1}
+fi
+
+# Make sure that gundam has been setup.
+if ! which gundamFitter; then
+    echo FAIL: Executable not found for gundamFitter
+    exit 1
+fi
+
+# Set the expected locations for the config and output files.
+export CONFIG_DIR=${DIR}
+export DATA_DIR=${PWD}
+
+CONFIG_FILE=${CONFIG_DIR}/200CovarianceFit-config.yaml
+
+# Keep the compiled formulas of this test in the output directory.
+export GUNDAM_FORMULA_CACHE=${DATA_DIR}/${BASE}-formulas
+rm -rf ${GUNDAM_FORMULA_CACHE}
+
+# Run the covariance fit with the override files given after the output
+# name.  Each override file turns on one of the opt-in reweighting modes (or
+# sets up the reference for it), and the fits are compared with the default
+# path by 900ReweightModesCheck.C.  All the fits use the same seed and the
+# same number of threads.
+runFit() {
+    OUTPUT_FILE=${DATA_DIR}/${BASE}-${1}.root
+    shift
+    OVERRIDE_FILES=""
+    if [ $# -gt 0 ]; then
+        OVERRIDE_FILES="-of"
+    fi
+    for OVERRIDE in "$@"; do
+        OVERRIDE_FILES="${OVERRIDE_FILES} ${CONFIG_DIR}/${BASE}-${OVERRIDE}.yaml"
+    done
+
+    echo ${OUTPUT_FILE}
+    echo ${CONFIG_FILE} ${OVERRIDE_FILES}
+
+    gundamFitter -t 2 -s 10000 --scan 10 \
+                 -c ${CONFIG_FILE} ${OVERRIDE_FILES} -o ${OUTPUT_FILE}
+}
+
+runFit default
+runFit mixedPrecision mixedPrecision
+runFit fused fused
+runFit splineBatches splineBatches
+runFit interned interned
+runFit generalSpline generalSpline
+runFit sharedKnotGrids generalSpline sharedKnotGrids
+runFit rootSpline rootSpline
+runFit tabulated rootSpline tabulated
+runFit formula formula
+runFit compiledFormula formula compiledFormula
+
+# The formula dials fall back to TFormula when the formula can't be
+# compiled, so make sure the compiled fit did use the compiler.
+if ! ls ${GUNDAM_FORMULA_CACHE}/*.so >& /dev/null; then
+    echo FAIL: No compiled formula in ${GUNDAM_FORMULA_CACHE}
+    exit 1
+fi
+
+# End of the script
@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# Set the base name for this test (should match the script name)
+BASE=800IncrementalReweight
+
+# Get the directory containing the script from the command line
+# parameters (avoids bash trickery).  Use the current directory as the
+# default.
+DIR=.
+if [ ${#1} -gt 0 ]; then
+    DIR=${1}
+fi
+
+# Make sure that gundam has been setup.
+if ! which gundamCalcXsec; then
+    echo FAIL: Executable not found for gundamCalcXsec
+    exit 1
+fi
+
+# Set the expected locations for the config and output files.
+export CONFIG_DIR=${DIR}
+export DATA_DIR=${PWD}
+
+FITTER_FILE=${DATA_DIR}/200IncrementalReweight.root
+
+# Throw the same toys (including the statistical throws of the MC
+# events) with the full reweight, and with the incremental reweight.
+# The event weights modified by the throws must not survive in the
+# events that don't depend on the thrown parameter.
+for MODE in full incremental; do
+    CONFIG_FILE=${CONFIG_DIR}/${BASE}-${MODE}.yaml
+    OUTPUT_FILE=${DATA_DIR}/${BASE}-${MODE}.root
+
+    echo ${OUTPUT_FILE}
+    echo ${CONFIG_FILE}
+
+    gundamCalcXsec -t 1 -s 10000 -n 20 -f ${FITTER_FILE} \
+                   -c ${CONFIG_FILE} -o ${OUTPUT_FILE}
+done
+
+# End of the script